@@ -2,6 +2,7 @@
 CC  := avr-gcc
 CXX := avr-g++
 SIZE := avr-size
+NM := avr-nm
 
 BIN_EXT :=.elf
 
@@ -42,8 +42,55 @@ class Resource:
    def get_code(self, source=False):
       return self.src if source else self.inc
 
+def rle_encode(data):
+   """
+   Pack the bytes as a sequence of runs and literals, each starting with a control byte.
+   A control byte with bit 7 set is followed by a byte to repeat (control & 0x7f) + 2 times.
+   Otherwise, it is followed by control + 1 bytes to copy as is.
+   """
+   out = []
+   literal = []
+
+   def flush_literal():
+      while literal:
+         chunk = literal[:128]
+         del literal[:128]
+         out.append(len(chunk) - 1)
+         out.extend(chunk)
+
+   i = 0
+   while i < len(data):
+      run = 1
+      while i + run < len(data) and data[i + run] == data[i] and run < 129:
+         run += 1
+
+      # A run of 2 only pays off when it doesn't break a literal
+      if run >= 3 or (run == 2 and not literal):
+         flush_literal()
+         out.append(0x80 | (run - 2))
+         out.append(data[i])
+         i += run
+      else:
+         literal.append(data[i])
+         i += 1
+
+   flush_literal()
+
+   return out
+
+
 class Bitmap(Resource):
+   COMPRESSIONS = {
+      "none": "GFX_MONO_BITMAP_PROGMEM",
+      "rle": "GFX_MONO_BITMAP_PROGMEM_RLE"
+   }
+
    def build(self, node):
+      compression = node.get("compression", "none")
+
+      if compression not in self.COMPRESSIONS:
+         raise ParserException(f"Invalid compression '{compression}' in resource ID {self.id}")
+
       im = Image.open(str(self.source_file));
       new_im = im.load()
 
@@ -61,17 +108,28 @@ class Bitmap(Resource):
             bloc += (str(new_im[x, y]))
          self.src.append(bloc)
 
+      # The display pages, top to bottom, a byte per column
+      data = [
+         sum([1<<k if new_im[x, y+k] else 0 for k in range(8)])
+            for y in range(0, height, 8) for x in range(0, width)
+      ]
+
+      if compression == "rle":
+         packed = rle_encode(data)
+      else:
+         packed = data
+
+      self.raw_size = len(data)
+      self.size = len(packed)
+
+      print(
+         f"   {compression}: {self.raw_size} -> {self.size} bytes "
+         f"({100 * self.size // self.raw_size}%)")
+
       self.src.append("const gfx_mono_color_t PROGMEM %s_header[] = {" % self.id)
 
-      for y in range(0, height, 8) :
-         for x in range(0, width, 8):
-            bloc="   "
-            for z in range(8):
-               bloc += "0x%.2x%s" % (
-                  sum([1<<k if new_im[x+z, y+k] else 0 for k in range(8)]),
-                  ',' if z==7 else ', '
-               )
-            self.src.append(bloc)
+      for i in range(0, len(packed), 8) :
+         self.src.append("   " + ", ".join(["0x%.2x" % b for b in packed[i:i+8]]) + ",")
 
       # Remote last ','
       self.src[-1] = self.src[-1][:-1]
@@ -84,7 +142,7 @@ class Bitmap(Resource):
       self.src.append(f"struct gfx_mono_bitmap {self.id}_bm = {{")
       self.src.append(f"   .width = {width},")
       self.src.append(f"   .height = {height},")
-      self.src.append("   .type = GFX_MONO_BITMAP_PROGMEM,")
+      self.src.append(f"   .type = {self.COMPRESSIONS[compression]},")
       self.src.append("   {")
       self.src.append(f"      .progmem = {self.id}_header")
       self.src.append("   }")
@@ -125,6 +183,13 @@ class ResourceParser:
                self.resources[id] = Bitmap(id, parent, res)
                self.resources[id].build(res)
 
+         bitmaps = [res for res in self.resources.values() if isinstance(res, Bitmap)]
+
+         if bitmaps:
+            raw_size = sum(res.raw_size for res in bitmaps)
+            size = sum(res.size for res in bitmaps)
+            print(f"Bitmaps: {raw_size} -> {size} bytes ({100 * size // raw_size}%)")
+
          for files in self.resource_dict.get("out", []):
             # Grab the source
             source = files.get("src", [])
@@ -9,6 +9,7 @@ CC  ?= gcc
 CXX ?= g++
 RC ?= make/rc.py
 SIZE ?= size
+NM ?= nm
 
 BUILD_DIR       := $(target)_$(build_type)
 
@@ -52,6 +53,14 @@ $(BUILD_DIR)/$(BIN)$(BIN_EXT) : $(OBJS)
 	$(mute)$(CXX) -Wl,--start-group $^ -Wl,--end-group ${LDFLAGS} -o $@
 	$(POST_LINK)
 	$(DIAG)
+	$(RAM_REPORT)
+
+# Print the static allocations, exported by ram_budget.cpp as absolute symbols
+define RAM_REPORT
+	@echo "Static allocations of the $(target) build, in bytes"
+	$(mute)$(NM) -t d $@ | awk '$$3 ~ /^ram_budget\./ { sub( /^ram_budget\./, "", $$3 ); printf "%6d %s\n", $$1, $$3 }' | sort -rn
+
+endef
 
 $(BUILD_DIR)/%.o : %.c $(BUILD_DIR)/%.d | $(@D)
 	@echo "Compiling $<"
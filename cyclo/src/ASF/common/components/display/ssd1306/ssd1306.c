@@ -37,6 +37,9 @@
 #include "font.h"
 
 #if defined(SSD1306_TWI_INTERFACE)
+#  include "FreeRTOS.h"
+#  include "task.h"
+
 #  ifndef SSD1306_BUFFER_SIZE
 #     define SSD1306_BUFFER_SIZE 8
 #  endif
@@ -50,6 +53,157 @@ twi_package_t twi_packet = {
 	.length      = 0,
 	.no_wait     = false
 };
+
+/* Spans of display RAM queued by ssd1306_queue_data(). Each span is sent by
+ * the TWI interrupt as a command write (page and column address) followed by
+ * a data write taken straight from the caller's buffer.
+ */
+static struct {
+	uint8_t command[3];
+	const uint8_t *data;
+	uint8_t size;
+} queue[SSD1306_QUEUE_SIZE];
+
+static uint8_t queued;
+
+static struct {
+	uint8_t next;                  // Next span to send
+	uint8_t sent;                  // Spans written out in full
+	bool data;                     // The next write is the span data
+	twi_package_t packet;          // Write in progress
+	TaskHandle_t waiting;          // Task to notify when done, if any
+	volatile bool busy;            // Cleared when the queue is sent
+} sender = {
+	.packet = {
+		.chip        = SSD1306_TWI_ADDR,
+		.addr_length = 1,
+		.no_wait     = false
+	}
+};
+
+/**
+ * \internal
+ * \brief Write the next command or data of the queue
+ *
+ * Called from the TWI interrupt when the previous write completes. Once the
+ * queue is sent, or on a bus error, the waiting task is notified.
+ */
+static void ssd1306_send_next(status_code_t status)
+{
+	if ((STATUS_OK == status) && !sender.data) {
+		/* The write which completed was span data, or nothing yet */
+		sender.sent = sender.next;
+	}
+
+	if ((STATUS_OK == status) && (sender.next < queued)) {
+		if (sender.data) {
+			sender.packet.addr[0] = 0b01000000;
+			sender.packet.buffer = (void *)queue[sender.next].data;
+			sender.packet.length = queue[sender.next].size;
+			++sender.next;
+		} else {
+			sender.packet.addr[0] = 0;
+			sender.packet.buffer = queue[sender.next].command;
+			sender.packet.length = sizeof(queue[sender.next].command);
+		}
+
+		sender.data = !sender.data;
+		status = twi_master_start(SSD1306_TWI, &sender.packet, false,
+				ssd1306_send_next);
+
+		if (STATUS_OK == status) {
+			return;
+		}
+	}
+
+	queued = 0;
+	sender.busy = false;
+
+	if (sender.waiting) {
+		/* Only a naked ISR, wrapped in portSTART_ISR() and
+		 * portEND_SWITCHING_ISR(), can switch context on this port. The
+		 * TWI interrupt of the ASF driver is not, so the waiting task
+		 * resumes at the latest on the next tick.
+		 */
+		vTaskNotifyGiveFromISR(sender.waiting, NULL);
+	}
+}
+
+/**
+ * \brief Queue a span of display RAM to send
+ *
+ * The data is not copied, and must not change until ssd1306_send_queued()
+ * returns.
+ *
+ * \param page    the page address
+ * \param column  the first column address
+ * \param data    the bytes to write from this column onwards
+ * \param size    the number of bytes
+ *
+ * \retval true   the span is queued
+ * \retval false  the queue is full, send it first
+ */
+bool ssd1306_queue_data(uint8_t page, uint8_t column, const uint8_t *data,
+		uint8_t size)
+{
+	if (queued == SSD1306_QUEUE_SIZE) {
+		return false;
+	}
+
+#ifdef SSD1306_COLUMN_OFFSET
+	column += SSD1306_COLUMN_OFFSET;
+#endif
+	column &= 0x7F;
+
+	queue[queued].command[0] = SSD1306_CMD_SET_PAGE_START_ADDRESS(page & 0x0F);
+	queue[queued].command[1] = SSD1306_CMD_SET_HIGH_COL(column >> 4);
+	queue[queued].command[2] = SSD1306_CMD_SET_LOW_COL(column & 0x0F);
+	queue[queued].data = data;
+	queue[queued].size = size;
+	++queued;
+
+	return true;
+}
+
+/**
+ * \brief Send the queued spans and empty the queue
+ *
+ * The transfer is carried by the TWI interrupt. Once the scheduler runs,
+ * the calling task is blocked until it completes, rather than polling.
+ *
+ * \return the number of spans written out in full, in the queued order. It
+ *         is less than the number queued when the bus failed.
+ */
+uint8_t ssd1306_send_queued(void)
+{
+	bool const blocking =
+			(xTaskGetSchedulerState() == taskSCHEDULER_RUNNING);
+
+	if (queued == 0) {
+		return 0;
+	}
+
+	sender.next = 0;
+	sender.sent = 0;
+	sender.data = false;
+	sender.busy = true;
+	sender.waiting = blocking ? xTaskGetCurrentTaskHandle() : NULL;
+
+	/* Start the chain as if a previous write had just completed */
+	ssd1306_send_next(STATUS_OK);
+
+	if (blocking) {
+		while (sender.busy) {
+			ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+		}
+	} else {
+		while (sender.busy) {
+			barrier();
+		}
+	}
+
+	return sender.sent;
+}
 #endif
 
 
@@ -277,7 +277,10 @@ static inline void ssd1306_write_cmd_buffer(const uint8_t *data, uint8_t size)
 	{
 		uint8_t count = min(size, SSD1306_BUFFER_SIZE);
 		memcpy(pTo, data, count);
-	    twi_packet.length = count;
+		data += count;
+
+		// The control byte is sent first
+	    twi_packet.length = count + 1;
 		twi_master_write(SSD1306_TWI, &twi_packet);	
 		size -= count;
 	}
@@ -311,9 +314,11 @@ static inline void ssd1306_write_data_buffer(const uint8_t *data, uint8_t size)
 		else
 		{
 			memcpy(pTo, data, count);
+			data += count;
 		}
 
-	    twi_packet.length = count;
+		// The control byte is sent first
+	    twi_packet.length = count + 1;
 		twi_master_write(SSD1306_TWI, &twi_packet);	
 		size -= count;
 	}
@@ -538,6 +543,20 @@ static inline void ssd1306_fill(void)
 void ssd1306_init(void);
 //@}
 
+#if defined(SSD1306_TWI_INTERFACE)
+//! \name Interrupt driven transfer of display RAM spans
+//@{
+#ifndef SSD1306_QUEUE_SIZE
+//! \brief Number of spans which can be queued, one per page by default
+# define SSD1306_QUEUE_SIZE (SSD1306_HEIGHT / 8)
+#endif
+
+bool ssd1306_queue_data(uint8_t page, uint8_t column, const uint8_t *data,
+		uint8_t size);
+uint8_t ssd1306_send_queued(void);
+//@}
+#endif
+
 //! \name Write text routine
 //@{
 void ssd1306_write_text(const char *string);
@@ -458,6 +458,10 @@ void gfx_mono_generic_draw_filled_circle(gfx_coord_t x, gfx_coord_t y,
  * Ie: placing a bitmap at x=10, y=5 will put the bitmap at x = 10,y = 0 and
  * placing a bitmap at x = 10, y = 10 will put the bitmap at x = 10, y = 8
  *
+ * Run-length encoded bitmaps are decoded as they are put, a byte at a time.
+ * The data is a sequence of packets, each starting with a control byte. If
+ * bit 7 is set, the next byte is repeated (control & 0x7F) + 2 times.
+ * Otherwise, the next control + 1 bytes are taken as they are.
  */
 void gfx_mono_generic_put_bitmap(struct gfx_mono_bitmap *bitmap, gfx_coord_t x,
 		gfx_coord_t y)
@@ -480,6 +484,41 @@ void gfx_mono_generic_put_bitmap(struct gfx_mono_bitmap *bitmap, gfx_coord_t x,
 		}
 		break;
 
+	case GFX_MONO_BITMAP_PROGMEM_RLE:
+	{
+		gfx_mono_color_t PROGMEM_T *data = bitmap->data.progmem;
+		uint8_t count = 0;
+		bool repeat = false;
+
+		temp = 0;
+
+		for (i = 0; i < num_pages; i++) {
+			for (column = 0; column < bitmap->width; column++) {
+				/* Start the next packet */
+				if (count == 0) {
+					uint8_t const control = PROGMEM_READ_BYTE(data++);
+
+					repeat = control & 0x80;
+
+					if (repeat) {
+						count = (control & 0x7F) + 2;
+						temp = PROGMEM_READ_BYTE(data++);
+					} else {
+						count = control + 1;
+					}
+				}
+
+				if (!repeat) {
+					temp = PROGMEM_READ_BYTE(data++);
+				}
+
+				--count;
+				gfx_mono_put_byte(i + page, column + x, temp);
+			}
+		}
+		break;
+	}
+
 	case GFX_MONO_BITMAP_RAM:
 		for (i = 0; i < num_pages; i++) {
 			gfx_mono_put_page(bitmap->data.pixmap
@@ -206,6 +206,77 @@ static void gfx_mono_draw_char_progmem(const char ch, const gfx_coord_t x,
 	} while (rows_left > 0);
 }
 
+/**
+ * \internal
+ * \brief Helper function that blits a character from a font in progmem
+ *        to the display, one column at a time
+ *
+ * For fonts which fit in a byte both ways. The glyph rows are first turned
+ * into display columns. Each column is then written over the character cell
+ * as a whole byte if the cell is aligned on a page, or shifted over two
+ * pages otherwise. The cell is cleared in the process.
+ *
+ * \param ch       Character to be drawn
+ * \param x        X coordinate on screen.
+ * \param y        Y coordinate on screen.
+ * \param font     Font to draw character in
+ */
+static void gfx_mono_blit_char_progmem(const char ch, const gfx_coord_t x,
+		const gfx_coord_t y, const struct font *font)
+{
+	uint8_t PROGMEM_PTR_T glyph_data;
+	uint8_t rows[CONFIG_FONT_PIXELS_PER_BYTE];
+	uint8_t const mask = 0xFF >> (CONFIG_FONT_PIXELS_PER_BYTE - font->height);
+	gfx_coord_t const page = y / GFX_MONO_LCD_PIXELS_PER_BYTE;
+	uint8_t const shift = y % GFX_MONO_LCD_PIXELS_PER_BYTE;
+	uint8_t row;
+	uint8_t i;
+
+	glyph_data = font->data.progmem +
+			font->height * ((uint8_t)ch - font->first_char);
+
+	for (row = 0; row < font->height; row++) {
+		rows[row] = PROGMEM_READ_BYTE(glyph_data);
+		glyph_data++;
+	}
+
+	for (i = 0; i < font->width; i++) {
+		gfx_coord_t const column = x + i;
+		uint8_t pixels = 0;
+
+		if (column > GFX_MONO_LCD_WIDTH - 1) {
+			break;
+		}
+
+		for (row = 0; row < font->height; row++) {
+			if (rows[row] & (0x80 >> i)) {
+				pixels |= 1 << row;
+			}
+		}
+
+		if ((shift == 0) && (mask == 0xFF)) {
+			gfx_mono_put_byte(page, column, pixels);
+			continue;
+		}
+
+		gfx_mono_put_byte(page, column,
+				(gfx_mono_get_byte(page, column) &
+				~(uint8_t)(mask << shift)) |
+				(uint8_t)(pixels << shift));
+
+		/* The part of the column spilling into the next page */
+		if ((shift + font->height > GFX_MONO_LCD_PIXELS_PER_BYTE) &&
+				(page + 1 < GFX_MONO_LCD_PAGES)) {
+			uint8_t const spill = GFX_MONO_LCD_PIXELS_PER_BYTE - shift;
+
+			gfx_mono_put_byte(page + 1, column,
+					(gfx_mono_get_byte(page + 1, column) &
+					~(uint8_t)(mask >> spill)) |
+					(uint8_t)(pixels >> spill));
+		}
+	}
+}
+
 /**
  * \brief Draws a character to the display
  *
@@ -217,6 +288,15 @@ static void gfx_mono_draw_char_progmem(const char ch, const gfx_coord_t x,
 void gfx_mono_draw_char(const char c, const gfx_coord_t x, const gfx_coord_t y,
 		const struct font *font)
 {
+	/* Small fonts in progmem go straight to the display memory */
+	if ((font->type == FONT_LOC_PROGMEM) &&
+			(font->width <= CONFIG_FONT_PIXELS_PER_BYTE) &&
+			(font->height <= CONFIG_FONT_PIXELS_PER_BYTE) &&
+			(y < GFX_MONO_LCD_HEIGHT)) {
+		gfx_mono_blit_char_progmem(c, x, y, font);
+		return;
+	}
+
 	gfx_mono_draw_filled_rect(x, y, font->width, font->height,
 			GFX_PIXEL_CLR);
 
@@ -273,6 +353,34 @@ void gfx_mono_draw_string(const char *str, gfx_coord_t x, gfx_coord_t y,
 	} while (*(++str));
 }
 
+/**
+ * \brief Draws a number as a fixed count of decimal digits
+ *
+ * The number is padded with leading zeros, and only its lower digits are
+ * drawn if it does not fit. No string is built in the process.
+ *
+ * \param value     Number to draw
+ * \param digits    Number of digits to draw
+ * \param x         X coordinate on screen of the first digit.
+ * \param y         Y coordinate on screen.
+ * \param font      Font to draw the digits in
+ */
+void gfx_mono_draw_digits(uint32_t value, uint8_t digits, gfx_coord_t x,
+		gfx_coord_t y, const struct font *font)
+{
+	/* Sanity check on parameters, assert if font is NULL. */
+	Assert(font != NULL);
+
+	/* Draw from the least significant digit, right to left */
+	x += digits * font->width;
+
+	while (digits--) {
+		x -= font->width;
+		gfx_mono_draw_char('0' + (value % 10), x, y, font);
+		value /= 10;
+	}
+}
+
 /**
  * \brief Draws a string located in program memory to the display
  *
@@ -107,6 +107,9 @@ void gfx_mono_draw_string(const char *str, const gfx_coord_t x,
 void gfx_mono_get_string_bounding_box(char const *str, const struct font *font,
 		gfx_coord_t *width, gfx_coord_t *height);
 
+void gfx_mono_draw_digits(uint32_t value, uint8_t digits, gfx_coord_t x,
+		gfx_coord_t y, const struct font *font);
+
 /** @} */
 
 /** \name Strings located in flash */
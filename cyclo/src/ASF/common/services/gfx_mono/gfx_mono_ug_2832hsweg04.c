@@ -35,6 +35,8 @@
  */
 #include "gfx_mono_ug_2832hsweg04.h"
 
+#include <string.h>
+
 /* If we are using a serial interface without readback, use framebuffer */
 #if defined(SSD1306_SERIAL_INTERFACE) || defined(SSD1306_TWI_INTERFACE)
 # define CONFIG_SSD1306_FRAMEBUFFER
@@ -44,6 +46,32 @@
 static uint8_t framebuffer[GFX_MONO_LCD_FRAMEBUFFER_SIZE];
 #endif
 
+#if defined(SSD1306_TWI_INTERFACE)
+/* Over TWI, the drawing only updates the framebuffer. The span of columns
+ * changed in each page is kept, and sent in one go by
+ * gfx_mono_ssd1306_flush(). A page is clean when its first dirty column is
+ * past its last one.
+ */
+static uint8_t dirty_first[GFX_MONO_LCD_PAGES];
+static uint8_t dirty_last[GFX_MONO_LCD_PAGES];
+
+static inline void gfx_mono_ssd1306_mark_dirty(gfx_coord_t page,
+		gfx_coord_t first, gfx_coord_t last)
+{
+	if (first < dirty_first[page]) {
+		dirty_first[page] = first;
+	}
+
+	if (last >= GFX_MONO_LCD_WIDTH) {
+		last = GFX_MONO_LCD_WIDTH - 1;
+	}
+
+	if (last > dirty_last[page]) {
+		dirty_last[page] = last;
+	}
+}
+#endif
+
 /**
  * \brief Initialize SSD1306 controller and LCD display.
  * It will also write the graphic controller RAM to all zeroes.
@@ -52,9 +80,6 @@ static uint8_t framebuffer[GFX_MONO_LCD_FRAMEBUFFER_SIZE];
  */
 void gfx_mono_ssd1306_init(void)
 {
-	uint8_t page;
-	uint8_t column;
-
 #ifdef CONFIG_SSD1306_FRAMEBUFFER
 	gfx_mono_set_framebuffer(framebuffer);
 #endif
@@ -69,22 +94,88 @@ void gfx_mono_ssd1306_init(void)
 	 * If using a framebuffer (SPI interface) it will both clear the
 	 * controller memory and the framebuffer.
 	 */
-	for (page = 0; page < GFX_MONO_LCD_PAGES; page++) {
+	gfx_mono_ssd1306_clear();
+	gfx_mono_ssd1306_flush();
+}
+
+/**
+ * \brief Clear the whole screen
+ *
+ * Over TWI, only the framebuffer is cleared, the screen is updated by
+ * gfx_mono_ssd1306_flush().
+ */
+void gfx_mono_ssd1306_clear(void)
+{
 #if defined(SSD1306_TWI_INTERFACE)
-	ssd1306_set_page_address(page);
-	ssd1306_set_column_address(0);
+	uint8_t page;
 
-	for (column = 0; column < GFX_MONO_LCD_WIDTH; column++) {
-		gfx_mono_framebuffer_put_byte(page, column, 0);
-	}
+	memset(framebuffer, 0, sizeof(framebuffer));
 
-	ssd1306_write_data_buffer(NULL, GFX_MONO_LCD_WIDTH);
+	for (page = 0; page < GFX_MONO_LCD_PAGES; page++) {
+		dirty_first[page] = 0;
+		dirty_last[page] = GFX_MONO_LCD_WIDTH - 1;
+	}
 #else
+	uint8_t page;
+	uint8_t column;
+
+	for (page = 0; page < GFX_MONO_LCD_PAGES; page++) {
 		for (column = 0; column < GFX_MONO_LCD_WIDTH; column++) {
 			gfx_mono_ssd1306_put_byte(page, column, 0x00, true);
 		}
-#endif		
 	}
+#endif
+}
+
+/**
+ * \brief Send the changes made to the framebuffer to the screen
+ *
+ * Each page changed is sent as a single TWI write, from its first to its
+ * last changed column. The writes are carried by the TWI interrupt, straight
+ * from the framebuffer, while the caller is blocked. A page stays dirty until
+ * its write completes, so the pages lost to a bus error are sent again by the
+ * next flush. Does nothing with the other interfaces, which update the screen
+ * as it is drawn.
+ */
+void gfx_mono_ssd1306_flush(void)
+{
+#if defined(SSD1306_TWI_INTERFACE)
+	uint8_t queued_pages[GFX_MONO_LCD_PAGES];
+	uint8_t page = 0;
+
+	while (page < GFX_MONO_LCD_PAGES) {
+		uint8_t queued = 0;
+		uint8_t sent;
+
+		for (; page < GFX_MONO_LCD_PAGES; page++) {
+			uint8_t first = dirty_first[page];
+			uint8_t last = dirty_last[page];
+
+			if (first > last) {
+				continue;
+			}
+
+			if (!ssd1306_queue_data(page, first,
+					framebuffer + (page * GFX_MONO_LCD_WIDTH) + first,
+					last - first + 1)) {
+				break;
+			}
+
+			queued_pages[queued++] = page;
+		}
+
+		sent = ssd1306_send_queued();
+
+		for (uint8_t i = 0; i < sent; i++) {
+			dirty_first[queued_pages[i]] = GFX_MONO_LCD_WIDTH;
+			dirty_last[queued_pages[i]] = 0;
+		}
+
+		if (sent < queued) {
+			break;
+		}
+	}
+#endif
 }
 
 #ifdef CONFIG_SSD1306_FRAMEBUFFER
@@ -101,6 +192,13 @@ void gfx_mono_ssd1306_put_framebuffer(void)
 {
 	uint8_t page;
 
+#if defined(SSD1306_TWI_INTERFACE)
+	for (page = 0; page < GFX_MONO_LCD_PAGES; page++) {
+		gfx_mono_ssd1306_mark_dirty(page, 0, GFX_MONO_LCD_WIDTH - 1);
+	}
+
+	gfx_mono_ssd1306_flush();
+#else
 	for (page = 0; page < GFX_MONO_LCD_PAGES; page++) {
 		ssd1306_set_page_address(page);
 		ssd1306_set_column_address(0);
@@ -108,6 +206,7 @@ void gfx_mono_ssd1306_put_framebuffer(void)
 				+ (page * GFX_MONO_LCD_WIDTH), page, 0,
 				GFX_MONO_LCD_WIDTH);
 	}
+#endif
 }
 #endif
 
@@ -226,12 +325,15 @@ void gfx_mono_ssd1306_put_page(gfx_mono_color_t *data, gfx_coord_t page,
 #ifdef CONFIG_SSD1306_FRAMEBUFFER
 	gfx_mono_framebuffer_put_page(data, page, column, width);
 #endif
-	ssd1306_set_page_address(page);
-	ssd1306_set_column_address(column);
 
 #if defined(SSD1306_TWI_INTERFACE)
-	ssd1306_write_data_buffer(data, width);
+	if (width) {
+		gfx_mono_ssd1306_mark_dirty(page, column, column + width - 1);
+	}
 #else
+	ssd1306_set_page_address(page);
+	ssd1306_set_column_address(column);
+
 	do {
 		ssd1306_write_data(*data++);
 	} while (--width);
@@ -298,10 +400,14 @@ void gfx_mono_ssd1306_put_byte(gfx_coord_t page, gfx_coord_t column,
 	gfx_mono_framebuffer_put_byte(page, column, data);
 #endif
 
+#if defined(SSD1306_TWI_INTERFACE)
+	gfx_mono_ssd1306_mark_dirty(page, column, column);
+#else
 	ssd1306_set_page_address(page);
 	ssd1306_set_column_address(column);
 
 	ssd1306_write_data(data);
+#endif
 }
 
 
@@ -122,6 +122,12 @@
 	gfx_mono_ssd1306_put_framebuffer()
 #endif
 
+#define gfx_mono_clear() \
+	gfx_mono_ssd1306_clear()
+
+#define gfx_mono_flush() \
+	gfx_mono_ssd1306_flush()
+
 void gfx_mono_ssd1306_put_framebuffer(void);
 
 void gfx_mono_ssd1306_put_page(gfx_mono_color_t *data, gfx_coord_t page,
@@ -145,6 +151,10 @@ uint8_t gfx_mono_ssd1306_get_byte(gfx_coord_t page, gfx_coord_t column);
 void gfx_mono_ssd1306_mask_byte(gfx_coord_t page, gfx_coord_t column,
 		gfx_mono_color_t pixel_mask, gfx_mono_color_t color);
 
+void gfx_mono_ssd1306_clear(void);
+
+void gfx_mono_ssd1306_flush(void);
+
 /** @} */
 
 #endif /* GFX_MONO_2832HSWEG04_H */
@@ -36,6 +36,7 @@
 
 
 #include "twim.h"
+#include "isr_probe.h"
 
 
 /* Master Transfer Descriptor */
@@ -49,6 +50,7 @@ static struct
 	bool            read;           // Bus transfer direction
 	bool            locked;         // Bus busy or unavailable
 	volatile status_code_t status;  // Transfer status
+	twi_callback_t  done;           // Completion of a non-blocking transfer
 
 } transfer;
 
@@ -67,16 +69,16 @@ static struct
 static void twim_interrupt_handler(void);
 
 #ifdef TWIC
-ISR(TWIC_TWIM_vect) { twim_interrupt_handler(); }
+ISR(TWIC_TWIM_vect) { isr_probe_enter(); twim_interrupt_handler(); isr_probe_exit(); }
 #endif
 #ifdef TWID
-ISR(TWID_TWIM_vect) { twim_interrupt_handler(); }
+ISR(TWID_TWIM_vect) { isr_probe_enter(); twim_interrupt_handler(); isr_probe_exit(); }
 #endif
 #ifdef TWIE
-ISR(TWIE_TWIM_vect) { twim_interrupt_handler(); }
+ISR(TWIE_TWIM_vect) { isr_probe_enter(); twim_interrupt_handler(); isr_probe_exit(); }
 #endif
 #ifdef TWIF
-ISR(TWIF_TWIM_vect) { twim_interrupt_handler(); }
+ISR(TWIF_TWIM_vect) { isr_probe_enter(); twim_interrupt_handler(); isr_probe_exit(); }
 #endif
 
 /**
@@ -285,6 +287,16 @@ static void twim_interrupt_handler(void)
 
 		transfer.status = ERR_PROTOCOL;
 	}
+
+	/* A non-blocking transfer releases the bus from here, and reports */
+
+	if (transfer.done && (OPERATION_IN_PROGRESS != transfer.status)) {
+
+		twi_callback_t const done = transfer.done;
+
+		transfer.done = NULL;
+		done(twim_release());
+	}
 }
 
 /**
@@ -307,6 +319,7 @@ status_code_t twi_master_init(TWI_t *twi, const twi_options_t *opt)
 
 	transfer.locked    = false;
 	transfer.status    = STATUS_OK;
+	transfer.done      = NULL;
 
 	/* Enable configured PMIC interrupt level. */
 
@@ -337,6 +350,35 @@ status_code_t twi_master_init(TWI_t *twi, const twi_options_t *opt)
  */
 status_code_t twi_master_transfer(TWI_t *twi,
 		const twi_package_t *package, bool read)
+{
+	/* Initiate a transaction when the bus is ready, then wait for it. */
+
+	status_code_t status = twi_master_start(twi, package, read, NULL);
+
+	if (STATUS_OK == status) {
+		status = twim_release();
+	}
+
+	return status;
+}
+
+/**
+ * \brief Start a TWI master write or read transfer, without waiting
+ *
+ * \param twi       Base address of the TWI (i.e. &TWI_t).
+ * \param package   Package information and data
+ *                  (see \ref twi_package_t)
+ * \param read      Selects the transfer direction
+ * \param done      Called from the interrupt with the outcome, or NULL if
+ *                  the caller releases the bus itself
+ *
+ * \return  status_code_t
+ *      - STATUS_OK if the transfer is started
+ *      - ERR_BUSY to indicate an unavailable bus
+ *      - ERR_INVALID_ARG to indicate invalid arguments.
+ */
+status_code_t twi_master_start(TWI_t *twi,
+		const twi_package_t *package, bool read, twi_callback_t done)
 {
 	/* Do a sanity check on the arguments. */
 
@@ -354,6 +396,7 @@ status_code_t twi_master_transfer(TWI_t *twi,
 		transfer.addr_count  = 0;
 		transfer.data_count  = 0;
 		transfer.read        = read;
+		transfer.done        = done;
 
 		uint8_t const chip = (package->chip) << 1;
 
@@ -362,8 +405,6 @@ status_code_t twi_master_transfer(TWI_t *twi,
 		} else if (read) {
 			transfer.bus->MASTER.ADDR = chip | 0x01;
 		}
-
-		status = twim_release();
 	}
 
 	return status;
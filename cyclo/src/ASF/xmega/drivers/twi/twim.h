@@ -103,6 +103,32 @@ status_code_t twi_master_init(TWI_t *twi, const twi_options_t *opt);
 status_code_t twi_master_transfer(TWI_t *twi, const twi_package_t *package,
 		bool read);
 
+/*! \brief Completion callback of a transfer started by twi_master_start()
+ *
+ * Called from the TWI interrupt once the bus is released, with the outcome
+ * of the transfer. It may start the next transfer.
+ */
+typedef void (*twi_callback_t)(status_code_t status);
+
+/*! \brief Start a TWI master write or read transfer, without waiting
+ *
+ * The transfer is carried by the TWI interrupt, and \c done is called when
+ * it completes. The package must remain valid until then.
+ *
+ * \param twi       Base address of the TWI (i.e. &TWI_t).
+ * \param package   Package information and data
+ *                  (see \ref twi_package_t)
+ * \param read      Selects the transfer direction
+ * \param done      Called from the interrupt with the outcome
+ *
+ * \return  status_code_t
+ *      - STATUS_OK if the transfer is started
+ *      - ERR_BUSY to indicate an unavailable bus
+ *      - ERR_INVALID_ARG to indicate invalid arguments.
+ */
+status_code_t twi_master_start(TWI_t *twi, const twi_package_t *package,
+		bool read, twi_callback_t done);
+
 /*! \brief Read multiple bytes from a TWI compatible slave device
  *
  * \param twi       Base address of the TWI (i.e. &TWI_t).
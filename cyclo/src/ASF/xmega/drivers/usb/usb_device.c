@@ -48,6 +48,7 @@
 #include "sysclk.h"
 #include "udd.h"
 #include "usb_device.h"
+#include "isr_probe.h"
 #include <string.h>
 
 #ifndef UDD_NO_SLEEP_MGR
@@ -777,7 +778,7 @@ bool udd_ep_wait_stall_clear(udd_ep_id_t ep,
  * - USB line events SOF, reset, suspend, resume, wakeup
  * - endpoint control errors underflow, overflow, stall
  */
-ISR(USB_BUSEVENT_vect)
+static void udd_interrupt_bus_event(void)
 {
 	if (udd_is_start_of_frame_event()) {
 		udd_ack_start_of_frame_event();
@@ -837,13 +838,20 @@ udd_interrupt_bus_event_end:
 	return;
 }
 
+ISR(USB_BUSEVENT_vect)
+{
+	isr_probe_enter();
+	udd_interrupt_bus_event();
+	isr_probe_exit();
+}
+
 /**
  * \internal
  * \brief Function called by USB transfer complete interrupt
  *
  * USB transfer complete interrupt includes events about endpoint transfer on all endpoints.
  */
-ISR(USB_TRNCOMPL_vect)
+static void udd_interrupt_tc(void)
 {
 #if (0!=USB_DEVICE_MAX_EP)
 	uint8_t ep_index;
@@ -915,6 +923,13 @@ udd_interrupt_tc_end:
 	return;
 }
 
+ISR(USB_TRNCOMPL_vect)
+{
+	isr_probe_enter();
+	udd_interrupt_tc();
+	isr_probe_exit();
+}
+
 //--------------------------------------------------------
 //--- INTERNAL ROUTINES TO INITIALIZE ENDPOINT
 
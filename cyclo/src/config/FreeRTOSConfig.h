@@ -68,7 +68,7 @@
     #define configUSE_MALLOC_FAILED_HOOK         0
 #endif
 #define configMAX_TASK_NAME_LEN                  8
-   #define configUSE_TRACE_FACILITY              0
+#define configUSE_TRACE_FACILITY                 1    // vTaskGetInfo for the 'top' command
 #define configUSE_16_BIT_TICKS                   0    // 0 means 32bit ticks
 #define configIDLE_SHOULD_YIELD                  1
 #define configQUEUE_REGISTRY_SIZE                0
@@ -84,6 +84,7 @@
 #define configMAX_CO_ROUTINE_PRIORITIES          2
 #define configNUMBER_OF_COROUTINES               6
 #define configUSE_TASK_NOTIFICATIONS             1
+#define configTASK_NOTIFICATION_ARRAY_ENTRIES    2    // Index 1 is reserved to rtos::Signal and rtos::EventFlags
 #define configUSE_MUTEXES                        1
 #define configUSE_RECURSIVE_MUTEXES              0
 #define configUSE_COUNTING_SEMAPHORES            0
@@ -97,8 +98,24 @@
 #define configENABLE_BACKWARD_COMPATIBILITY      0
 #define configNUM_THREAD_LOCAL_STORAGE_POINTERS  0
 /* Run time and task stats gathering related definitions. */
-#define configGENERATE_RUN_TIME_STATS            0
+#define configGENERATE_RUN_TIME_STATS            1
 #define configUSE_STATS_FORMATTING_FUNCTIONS     0
+#define configUSE_APPLICATION_TASK_TAG           1    // The tag counts the context switches
+
+// Count the times each task is switched in, in its tag
+#define traceTASK_SWITCHED_IN() \
+   pxCurrentTCB->pxTaskTag = ( TaskHookFunction_t )( ( uintptr_t )pxCurrentTCB->pxTaskTag + 1 )
+
+#ifndef _POSIX
+   // The run time is the microsecond timebase, less the time spent in the interrupts (see timebase.hpp)
+   #ifdef __cplusplus
+   extern "C"
+   #endif
+   uint32_t rtos_run_time_counter( void );
+
+   #define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS() // The timebase is started by main
+   #define portGET_RUN_TIME_COUNTER_VALUE()         rtos_run_time_counter()
+#endif
 #define configTIMER_TASK_PRIORITY                (configMAX_PRIORITIES - 1)
 #define configTIMER_QUEUE_LENGTH                 5
 #define configTIMER_TASK_STACK_DEPTH             (configMINIMAL_STACK_SIZE + 128)
@@ -115,8 +132,8 @@ to exclude the API function. */
 #define INCLUDE_vTaskDelay                       1
 #define INCLUDE_xTaskGetSchedulerState           0
 #define INCLUDE_xTaskGetCurrentTaskHandle        0
-#define INCLUDE_uxTaskGetStackHighWaterMark      0
-#define INCLUDE_xTaskGetIdleTaskHandle           0
+#define INCLUDE_uxTaskGetStackHighWaterMark      1 // Stack usage report
+#define INCLUDE_xTaskGetIdleTaskHandle           1
 #define INCLUDE_eTaskGetState                    0
 #define INCLUDE_xEventGroupSetBitFromISR         0
 #define INCLUDE_xTimerPendFunctionCall           1
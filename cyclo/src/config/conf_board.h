@@ -35,6 +35,14 @@
 #define KEYPAD_TC   TCD0
 #define NONC_TC     TCE0
 
+// The timebase chains 2 timers through the event channels 0 and 1
+#define TIMEBASE_LO_TC TCC1
+#define TIMEBASE_HI_TC TCD1
+#define TIMEBASE_LO_OVF_EVENT EVSYS_CHMUX_TCC1_OVF_gc
+
+// The hardware timers use the compare channel A of the low timebase timer
+#define HWTIMER_TC  TIMEBASE_LO_TC
+
 /*
  * Keypad defines
  */
@@ -6,11 +6,24 @@
  * Created: 17/07/2021 18:33:44
  *  Author: software@arreckx.com
  */ 
+#include "conf_ram.hpp"
 
 namespace cyclo
 {
-   /** Max number of commands per programs */
-   constexpr size_t max_items_per_command = 12;
+   /** Number of bytes of a packed program. A step takes 1 to 3 bytes, up to a 20 minutes delay */
+   constexpr size_t program_size = 160;
+
+   /** Resolution of the program delays. Matches the rtos tick */
+   constexpr uint16_t ms_per_tick = 10;
+
+   /** Number of program slots in the eeprom, including the manual program */
+   constexpr size_t max_programs = 16;
+
+   /** Longest program source text stored. The text is the console line */
+   constexpr size_t program_text_size = console_line_size;
+
+   /** Most screen updates per second caused by the program activity */
+   constexpr uint8_t ui_frame_rate = 25;
 }
 
 
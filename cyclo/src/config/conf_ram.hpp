@@ -0,0 +1,65 @@
+#ifndef CONF_RAM_H_
+#define CONF_RAM_H_
+/*
+ * conf_ram.hpp
+ *
+ * Sizes of all the static allocations, in one place, to trade memory between
+ *  the subsystems deliberately.
+ * ram_budget.cpp adds up what they cost, and checks the total fits the budget.
+ * The kernel own allocations (idle and timer tasks) are set in FreeRTOSConfig.h.
+ */
+#include <cstddef>
+
+namespace cyclo
+{
+   /** RAM of the ATxmega128A4U */
+   constexpr size_t ram_size = 8192;
+
+   /** Left to the startup stack (also used by the interrupts before the scheduler), USB and ASF */
+   constexpr size_t ram_reserve = 1024;
+
+   /** RAM the allocations below can use */
+   constexpr size_t ram_budget = ram_size - ram_reserve;
+
+   // Stacks. In words, on top of configMINIMAL_STACK_SIZE
+
+   /** Sequencer dispatcher task */
+   constexpr size_t sequencer_stack = 32;
+
+   /** User interface dispatcher task. The display rendering is deep */
+   constexpr size_t ui_stack = 128;
+
+   /** Console task. The parser and the program printing are deep */
+   constexpr size_t console_stack = 256;
+
+   /** Eeprom writer task */
+   constexpr size_t nvm_stack = 64;
+
+   // Queues. In number of items
+
+   /** Messages waiting for the sequencer */
+   constexpr size_t sequencer_queue_length = 4;
+
+   /** Messages waiting for the user interface - the keypad can burst */
+   constexpr size_t ui_queue_length = 8;
+
+   /** Number of eeprom page jobs queued before the writers block. Holds a whole program save */
+   constexpr size_t nvm_queue_length = 10;
+
+   // Buffers. In bytes, or items
+
+   /** Longest console line */
+   constexpr size_t console_line_size = 40;
+
+   /** Console history, in a ring of bytes */
+   constexpr size_t console_history_size = 128;
+
+   /** Longest console error message */
+   constexpr size_t console_error_size = 80;
+
+   /** Number of edges kept in the post-mortem edge log. Power of 2 */
+   constexpr size_t edge_log_size = 32;
+}
+
+
+#endif /* CONF_RAM_H_ */
@@ -34,11 +34,17 @@ SOFTWARE.
 
 #include <fx.hpp>
 
+#include <etl/to_string.h>
+
+#include <cstring>
+
 #include <logger.h>
 
 #include "console_server.hpp"
+#include "edge_log.hpp"
 #include "msg_defs.hpp"
 #include "program_manager.hpp"
+#include "ram_budget.hpp"
 
 using rtos::tick_t;
 
@@ -47,7 +53,7 @@ namespace
 {
    const char *const DOM = "console";
 
-   auto cdc_available_semaphore = rtos::BinarySemaphore{};
+   auto cdc_available = rtos::Signal{};
    bool cdc_transfert_allowed{ false };
    bool first_time{ true };
    bool usb_mode{ false };
@@ -60,7 +66,7 @@ extern "C" bool console_cdc_enabled( uint8_t port )
 {
    UNUSED( port );
    cdc_transfert_allowed = true;
-   cdc_available_semaphore.give_from_isr( nullptr );
+   cdc_available.give_from_isr( nullptr );
    trace_set( TRACE_INFO );
 
    return true;
@@ -79,9 +85,16 @@ void console_putc( vt100::char_t c )
    udi_cdc_multi_putc( 0, (int)c );
 }
 
+/** Raw binary write - used for bulk transfers */
+void console_write( const void *buf, size_t size )
+{
+   udi_cdc_write_buf( buf, size );
+}
+
 /** Create the timer for the splash */
 Console::Console( ProgramManager &program_manager )
    : parser{ temp_program, error_buffer }
+   , server{ parser }
    , program_manager{ program_manager }
    , task( etl::delegate<void()>::create<Console, &Console::run>( *this ) )
 {}
@@ -141,7 +154,7 @@ void Console::run()
       if ( ! cdc_transfert_allowed )
       {
          server.reset();
-         cdc_available_semaphore.take();
+         cdc_available.wait();
       }
 
       if ( first_time )
@@ -151,6 +164,7 @@ void Console::run()
          first_time = false;
       }
 
+      parser.start();
       server.print_prompt();
 
       while ( ! v )
@@ -173,9 +187,13 @@ void Console::run()
    }
 }
 
+/**
+ * The line was parsed as it was typed, so only the result is left to process
+ * @param line The whole line, or empty if the line did not fit the buffer
+ */
 void Console::process( etl::string_view line )
 {
-   auto res = parser.parse( line );
+   auto res = parser.finish();
 
    switch ( res )
    {
@@ -190,14 +208,27 @@ void Console::process( etl::string_view line )
 
       program_manager.load( temp_program );
       // Copy this program, so it can be saved as is
-      last_program.clear();
-      last_program.assign( line.begin(), line.end() );
+      last_program = temp_program;
+      last_text.assign( line.begin(), line.end() );
       break;
    case Parser::Result::help: show_help(); break;
-   case Parser::Result::list:
-      program_manager.scan();
-      show_list();
+   case Parser::Result::list: show_list(); break;
+   case Parser::Result::verify:
+      if ( auto dropped = program_manager.scan() )
+      {
+         show_number( dropped );
+         TTerminal::print_P( PSTR( " bad program(s) dropped" ) );
+      }
+      else
+      {
+         TTerminal::print_P( PSTR( "All programs OK" ) );
+      }
+
+      TTerminal::move_to_start_of_next_line();
       break;
+   case Parser::Result::edges: edge_log::dump( console_write ); break;
+   case Parser::Result::memory: show_memory(); break;
+   case Parser::Result::top: show_top(); break;
    case Parser::Result::quit:
       usb_mode = false;
       fx::publish( msg::StopProgram{} );
@@ -236,11 +267,15 @@ void Console::process( etl::string_view line )
       {
          auto pgmNumber = parser.get_program_number();
 
-         // Store
-         program_manager.write_pgm_at( pgmNumber, last_program );
-
-         // Make it the last used
-         program_manager.set_lastused( pgmNumber );
+         if ( not program_manager.write_pgm_at( pgmNumber, last_program, last_text ) )
+         {
+            print_error( PSTR( "Not enough space left" ) );
+         }
+         else
+         {
+            // Make it the last used
+            program_manager.set_lastused( pgmNumber );
+         }
       }
 
       break;
@@ -288,13 +323,17 @@ void Console::show_help()
       "\r\n"
       "Other commands:\r\n"
       "  list           : List saved programs\n\r"
-      "  save [1-9]     : Save the last valid program\r\n"
-      "  del [1-9]      : Delete the program at the given location\r\n"
-      "  run [0-9]      : Run the given program\r\n"
-      "  auto [0-9|off] : Start the program automatically on power-up - or turn off\r\n"
+      "  save [1-15]    : Save the last valid program\r\n"
+      "  del [1-15]     : Delete the program at the given location\r\n"
+      "  run [0-15]     : Run the given program\r\n"
+      "  auto [0-15|off]: Start the program automatically on power-up - or turn off\r\n"
+      "  verify         : Check all the saved programs\r\n"
+      "  memory         : Stack size and peak usage of each task, and the RAM budget\r\n"
+      "  top            : CPU load, context switches and free stack since the last 'top'\r\n"
+      "  edges          : Binary dump of the last relay edges (see tools/edges.py)\r\n"
       "  quit           : Leave this shell and re-enable manual mode\r\n"
       "Fast run:\r\n"
-      "  [0-9]          : Type a valid program number to run it.\r\n" );
+      "  [0-15]         : Type a valid program number to run it.\r\n" );
 
    TTerminal::print_P( help );
 }
@@ -313,11 +352,144 @@ void Console::show_list()
       // Print the index
       TTerminal::move_forward();
       TTerminal::putc( autostart_index == index ? '*' : ' ' );
-      TTerminal::move_forward( 2 );
-      TTerminal::putc( '0' + index );
+      TTerminal::move_forward( index < 10 ? 2 : 1 );
+      show_number( index );
       TTerminal::putc( ':' );
       TTerminal::move_forward( 4 );
-      TTerminal::puts( program_manager.get_pgm( index ) );
+
+      // Show the source if stored, or decompile the program
+      etl::string<cyclo::program_text_size> text;
+
+      if ( program_manager.get_text( index, text ) )
+      {
+         for ( auto c : text )
+         {
+            TTerminal::putc( c );
+         }
+      }
+      else if ( program_manager.read( index, temp_program ) )
+      {
+         show_program( temp_program );
+      }
+
       TTerminal::move_to_start_of_next_line();
    } while ( next_index > 0 );
 }
+
+void Console::show_memory()
+{
+   TTerminal::print_P( PSTR( "Task      Size  Used" ) );
+   TTerminal::move_to_start_of_next_line();
+
+   rtos::TaskRegistry::report_stack_usage(
+      rtos::TaskRegistry::report_t::create<&Console::show_stack_usage>() );
+
+   TTerminal::print_P( PSTR( " Bytes Static" ) );
+   TTerminal::move_to_start_of_next_line();
+
+   ram_budget::report( ram_budget::report_t::create<&Console::show_allocation>() );
+}
+
+void Console::show_allocation( const char *name, size_t bytes )
+{
+   show_number( bytes, 6 );
+   TTerminal::putc( ' ' );
+   TTerminal::print_P( name );
+   TTerminal::move_to_start_of_next_line();
+}
+
+void Console::show_stack_usage( const rtos::StackUsage &usage )
+{
+   size_t length = strlen( usage.name );
+
+   TTerminal::puts( usage.name );
+   show_number( usage.size, 14 - length );
+   show_number( usage.size - usage.unused, 6 );
+   TTerminal::move_to_start_of_next_line();
+}
+
+void Console::show_top()
+{
+   TTerminal::print_P( PSTR( "Task    CPU%  Sw Free" ) );
+   TTerminal::move_to_start_of_next_line();
+
+   rtos::TaskRegistry::report_task_stats(
+      rtos::TaskRegistry::stats_report_t::create<&Console::show_task_stats>() );
+}
+
+void Console::show_task_stats( const rtos::TaskStats &stats )
+{
+   size_t length = strlen( stats.name );
+
+   TTerminal::puts( stats.name );
+   show_number( stats.load / 10, 10 - length );
+   TTerminal::putc( '.' );
+   show_number( stats.load % 10 );
+   show_number( stats.switches, 4 );
+
+   // The interrupts have no stack of their own
+   if ( stats.size )
+   {
+      show_number( stats.unused, 5 );
+   }
+
+   TTerminal::move_to_start_of_next_line();
+}
+
+void Console::show_number( uint32_t value, uint8_t width )
+{
+   etl::string<10> str;
+
+   etl::to_string( value, str );
+
+   for ( auto i = str.size(); i < width; ++i )
+   {
+      TTerminal::putc( ' ' );
+   }
+
+   TTerminal::puts( str.c_str() );
+}
+
+void Console::show_program( const Program &pgm )
+{
+   using Unit = etl::pair<char, uint32_t>;
+
+   // Largest unit first, so the shortest form is used
+   static constexpr Unit unit_lut[] = {
+      { 'H', 60ul * 60ul * 1000ul }, { 'M', 60ul * 1000ul }, { 's', 1000 }, { 'm', 1 } };
+
+   for ( auto step = pgm.begin(); step != pgm.end(); ++step )
+   {
+      Command  cmd      = *step;
+      uint32_t delay_ms = cmd.delay_ms();
+
+      if ( step != pgm.begin() )
+      {
+         TTerminal::putc( ' ' );
+      }
+
+      switch ( cmd.command )
+      {
+      case Command::open: TTerminal::putc( 'o' ); break;
+      case Command::close: TTerminal::putc( 'c' ); break;
+      case Command::loop: TTerminal::putc( '*' ); break;
+      case Command::delay:
+      default: break;
+      }
+
+      if ( delay_ms )
+      {
+         auto *unit = etl::find_if( etl::begin( unit_lut ), etl::end( unit_lut ), [ delay_ms ]( const Unit &u ) {
+            return delay_ms % u.second == 0;
+         } );
+
+         if ( cmd.command != Command::delay )
+         {
+            TTerminal::putc( ' ' );
+         }
+
+         show_number( delay_ms / unit->second );
+         TTerminal::putc( unit->first );
+      }
+   }
+}
@@ -0,0 +1,112 @@
+/******************************************************************************
+The MIT License(MIT)
+https://github.com/adarwoo/cyclo
+
+Copyright(c) 2021 Guillaume ARRECKX - software@arreckx.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+******************************************************************************/
+/*
+ * Ring of timestamped edges.
+ * Writers claim a slot by incrementing the head with the interrupts masked
+ *  for a handful of cycles, then fill the slot in. There is no lock, so
+ *  writing an edge never blocks the switching path.
+ */
+#include "edge_log.hpp"
+
+#include "asx.h"
+
+#include <rtos.hpp>
+#include <timebase.hpp>
+
+
+namespace
+{
+   using namespace edge_log;
+
+   constexpr uint8_t mask = cyclo::edge_log_size - 1;
+
+   ///< The ring
+   Record ring[ cyclo::edge_log_size ];
+
+   ///< Number of records ever written. The low bits index the ring
+   volatile uint16_t head = 0;
+
+   ///< Timestamp taken at boot, and time from then to the first edge
+   uint32_t boot_us       = 0;
+   uint32_t first_edge_us = 0;
+
+#ifdef _POSIX
+   inline uint16_t claim() { return __atomic_fetch_add( &head, 1, __ATOMIC_RELAXED ); }
+#else
+   inline uint16_t claim()
+   {
+      irqflags_t flags = cpu_irq_save();
+      uint16_t   slot  = head;
+      head             = slot + 1;
+      cpu_irq_restore( flags );
+
+      return slot;
+   }
+#endif
+}  // namespace
+
+
+namespace edge_log
+{
+   uint32_t now_us() { return rtos::now_us(); }
+
+   void start() { boot_us = now_us(); }
+
+   void record( flags_t flags, uint8_t step )
+   {
+      uint16_t slot = claim();
+      Record  &r    = ring[ slot & mask ];
+
+      r.timestamp_us = now_us();
+      r.step         = step;
+      r.flags        = flags;
+
+      // The head wraps, so only the very first edge sets it
+      if ( slot == 0 and first_edge_us == 0 )
+      {
+         first_edge_us = r.timestamp_us - boot_us;
+      }
+   }
+
+   void dump( void ( *write )( const void *, size_t ) )
+   {
+      uint16_t total = head;
+      uint8_t  count = ( total < cyclo::edge_log_size ) ? total : cyclo::edge_log_size;
+      uint8_t  first = ( total - count ) & mask;
+
+      Header header = {
+         { 'C', 'Y', 'E', 'D' }, version, sizeof( Record ), count, 0, total, now_us(), first_edge_us };
+
+      write( &header, sizeof( header ) );
+
+      // Oldest records first - the ring is sent in at most 2 chunks
+      uint8_t chunk = ( count < cyclo::edge_log_size - first ) ? count : cyclo::edge_log_size - first;
+
+      write( &ring[ first ], chunk * sizeof( Record ) );
+
+      if ( count > chunk )
+      {
+         write( &ring[ 0 ], ( count - chunk ) * sizeof( Record ) );
+      }
+   }
+}  // namespace edge_log
@@ -8,9 +8,12 @@
  *  Author: micro
  */
 
+#include <hw_timer.hpp>
 #include <rtos.hpp>
 #include <typestring.hpp>
 
+#include <new>
+
 #include <etl/delegate.h>
 #include <etl/function.h>
 #include <etl/message.h>
@@ -47,6 +50,141 @@ namespace fx
    /** Publish a message at the root dispatcher */
    void publish( const etl::imessage &msg_ );
 
+   /** Stamp of a message published by a timer - its slot index + 1 and serial, or 0 */
+   using stamp_t = uint16_t;
+
+   /**
+    * Handle to a message published later, or periodically.
+    * Once cancelled, the message is never delivered, even if it is already queued.
+    * Cancelling a message already delivered, or cancelled, does nothing.
+    * The serial is 16 bits wide, so a stale handle is only confused with a new use of its
+    *  slot after 65536 reuses. Holders should still reset their handle once delivered.
+    * Assigning to a handle cancels the message it holds, so a holder never leaves one
+    *  behind, still running with no way to reach it.
+    */
+   class TimerHandle
+   {
+      uint8_t  slot;    ///< Index of the slot + 1, or 0 if none
+      uint16_t serial;  ///< Serial of the slot when allocated
+
+   public:
+      constexpr TimerHandle( uint8_t slot = 0, uint16_t serial = 0 ) : slot{ slot }, serial{ serial } {}
+
+      TimerHandle( const TimerHandle & ) = default;
+
+      /** Cancel the message held, then hold the other one */
+      TimerHandle &operator=( const TimerHandle &other )
+      {
+         if ( slot != other.slot or serial != other.serial )
+         {
+            cancel();
+            slot   = other.slot;
+            serial = other.serial;
+         }
+
+         return *this;
+      }
+
+      /** Cancel the message */
+      void cancel();
+
+      /** @return true while the message is waiting for its time */
+      bool is_pending() const;
+
+      /** @return The time left before the message is published in ms, or 0 */
+      uint32_t remaining_ms() const;
+   };
+
+   /**
+    * The timer service behind publish_after and publish_every.
+    * The messages are copied into a fixed number of slots, each with a hardware timer.
+    * A slot is reused once its timer is stopped, and all its queued messages are delivered.
+    */
+   namespace timed
+   {
+      ///< Number of messages which can wait at once
+      constexpr uint8_t slots = 6;
+
+      ///< Largest message which can wait - a few bytes of payload
+      constexpr size_t message_size = sizeof( etl::imessage ) + 8;
+
+      /**
+       * A message waiting for its time, with its timer. Private to fx.cpp.
+       * The slot can be reused once stopped, and its published copies are all off the queues.
+       */
+      struct Slot
+      {
+         rtos::HwTimer timer;
+
+         ///< Copy of the message
+         alignas( max_align_t ) uint8_t storage[ message_size ];
+         etl::imessage *msg;
+
+         ///< Time left to wait once the current chunk expires
+         uint32_t left_ms;
+
+         ///< True for a periodic message
+         bool periodic;
+
+         ///< True until the message is published (one-shot) or cancelled
+         bool armed;
+
+         ///< Changed on every allocation and cancel. The queued copies of another serial are dropped
+         uint16_t serial;
+
+         ///< Number of copies queued, or being published
+         uint8_t in_flight;
+
+         Slot();
+
+         ///< Wait for the next chunk, or publish. Called from the timer daemon task
+         void expired();
+      };
+
+      ///< RAM taken by a slot
+      constexpr size_t slot_size = sizeof( Slot );
+
+      ///< Copy a message into a slot
+      using copy_t = etl::imessage *( * )( void *to, const etl::imessage &from );
+
+      ///< Copy the message in a free slot and start its timer
+      ///< Running out of slots is a design error. It is logged, and the system halts
+      TimerHandle start( const etl::imessage &msg, copy_t copy, uint32_t ms, bool periodic );
+
+      ///< @return The stamp of the message being published by the calling task, or 0
+      stamp_t current_stamp();
+
+      ///< Account for a stamped message queued
+      void queued( stamp_t stamp );
+
+      ///< Account for a stamped message taken off a queue. @return false if it was cancelled
+      bool dequeued( stamp_t stamp );
+
+      template<class T>
+      etl::imessage *copy( void *to, const etl::imessage &from )
+      {
+         return new ( to ) T( static_cast<const T &>( from ) );
+      }
+   }  // namespace timed
+
+   /** Publish a message once the delay in ms has elapsed */
+   template<class T>
+   TimerHandle publish_after( const T &msg, uint32_t delay_ms )
+   {
+      static_assert( sizeof( T ) <= timed::message_size, "The message is too large to wait" );
+
+      return timed::start( msg, &timed::copy<T>, delay_ms, false );
+   }
+
+   /** Publish a message every period in ms, until cancelled */
+   template<class T>
+   TimerHandle publish_every( const T &msg, uint32_t period_ms )
+   {
+      static_assert( sizeof( T ) <= timed::message_size, "The message is too large to wait" );
+
+      return timed::start( msg, &timed::copy<T>, period_ms, true );
+   }
+
    /** Allow creating unique auto-incrementing routers ID */
    static inline etl::message_router_id_t message_router_auto_id{ 0 };
 
@@ -98,8 +236,15 @@ namespace fx
       const size_t        QUEUESIZE   = 4>
    class Dispatcher : public etl::message_bus<MAX_ROUTERS>
    {
-      rtos::Queue<TPacket, QUEUESIZE> queue;
-      rtos::Task<TName, STACKSIZE>    task;
+      ///< A queued message, with the stamp of the timer which published it
+      struct Item
+      {
+         TPacket packet;
+         stamp_t stamp;
+      };
+
+      rtos::Queue<Item, QUEUESIZE>  queue;
+      rtos::Task<TName, STACKSIZE>  task;
 
    public:
       Dispatcher()
@@ -117,8 +262,14 @@ namespace fx
    protected:
       void receive( const etl::imessage &msg_ ) override
       {
-         auto packet = TPacket( msg_ );
-         queue.send( packet );
+         auto item = Item{ TPacket( msg_ ), timed::current_stamp() };
+
+         if ( item.stamp )
+         {
+            timed::queued( item.stamp );
+         }
+
+         queue.send( item );
       }
 
       void run()
@@ -129,10 +280,17 @@ namespace fx
 
          while ( true )
          {
-            auto packet = TPacket();
+            auto item = Item();
+
+            queue.receive( item );
+
+            // Drop the messages cancelled while queued
+            if ( item.stamp and not timed::dequeued( item.stamp ) )
+            {
+               continue;
+            }
 
-            queue.receive( packet );
-            auto &msg = packet.get();
+            auto &msg = item.packet.get();
             etl::message_bus<MAX_ROUTERS>::receive(
                etl::imessage_router::ALL_MESSAGE_ROUTERS, msg );
          }
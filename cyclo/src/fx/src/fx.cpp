@@ -17,7 +17,96 @@ namespace fx
    {
       // Debug domain
       const char * const DOM = "fx";
-   
+
+      ///< Longest wait of the hardware timer in ms. Longer delays are waited in chunks
+      constexpr uint32_t max_chunk_ms = 60000;
+
+      using timed::Slot;
+
+      ///< The pool of slots, created on first use
+      Slot *get_slots()
+      {
+         static Slot slots[ timed::slots ];
+
+         return slots;
+      }
+
+      ///< Task publishing a stamped message, and its stamp
+      TaskHandle_t stamping_task = nullptr;
+      stamp_t      stamping      = 0;
+
+      ///< The stamp keeps the low byte of the serial. A slot is not reused while stamped
+      ///<  copies are queued, so the serial moves by one at most (a cancel) meanwhile
+      inline stamp_t make_stamp( uint8_t index, uint16_t serial )
+      {
+         return ( stamp_t( index + 1 ) << 8 ) | uint8_t( serial );
+      }
+
+      ///< @return The slot of a stamp or handle (index + 1), or nullptr
+      Slot *find_slot( uint8_t index )
+      {
+         return ( index > 0 and index <= timed::slots ) ? &get_slots()[ index - 1 ] : nullptr;
+      }
+
+   }  // namespace
+
+   namespace timed
+   {
+      Slot::Slot()
+         : timer{ rtos::HwTimer::callback_t::create<Slot, &Slot::expired>( *this ) }
+         , msg{ nullptr }
+         , left_ms{ 0 }
+         , periodic{ false }
+         , armed{ false }
+         , serial{ 0 }
+         , in_flight{ 0 }
+      {}
+
+      void Slot::expired()
+      {
+         taskENTER_CRITICAL();
+
+         // Cancelled while the call was pending
+         if ( not armed )
+         {
+            taskEXIT_CRITICAL();
+            return;
+         }
+
+         if ( left_ms )
+         {
+            uint32_t chunk = etl::min( left_ms, max_chunk_ms );
+            left_ms -= chunk;
+            taskEXIT_CRITICAL();
+
+            timer.start( chunk * 1000 );
+            return;
+         }
+
+         // Hold the slot while publishing, so it cannot be reused
+         uint16_t the_serial = serial;
+         ++in_flight;
+         taskEXIT_CRITICAL();
+
+         stamping_task = xTaskGetCurrentTaskHandle();
+         stamping      = make_stamp( this - get_slots(), the_serial );
+         publish( *msg );
+         stamping = 0;
+
+         taskENTER_CRITICAL();
+         --in_flight;
+
+         if ( not periodic and serial == the_serial )
+         {
+            armed = false;
+         }
+
+         taskEXIT_CRITICAL();
+      }
+   }  // namespace timed
+
+   namespace
+   {
       // The unique instance of the root dispatcher
       etl::imessage_bus *root_dispatcher = nullptr;
 
@@ -62,4 +151,136 @@ namespace fx
    
       root_dispatcher->receive(msg_);
    }
+
+   namespace timed
+   {
+      TimerHandle start( const etl::imessage &msg, copy_t copy, uint32_t ms, bool periodic )
+      {
+         // The periodic messages rely on the timer period not to drift
+         assert( not periodic or ( ms > 0 and ms <= max_chunk_ms ) );
+
+         Slot *slots = get_slots();
+         Slot *slot  = nullptr;
+
+         taskENTER_CRITICAL();
+
+         for ( uint8_t i = 0; i < timed::slots; ++i )
+         {
+            if ( not slots[ i ].armed and slots[ i ].in_flight == 0 )
+            {
+               slot        = &slots[ i ];
+               slot->armed = true;
+               ++slot->serial;
+               break;
+            }
+         }
+
+         taskEXIT_CRITICAL();
+
+         // The slots are sized for the application. Carrying on would silently lose a
+         //  message, and stall whoever waits for it, so halt and let the watchdog reset
+         if ( slot == nullptr )
+         {
+            LOG_ERROR( DOM, "No timer slot left" );
+
+#ifndef _POSIX
+            asm( "break" );
+#endif
+            while ( true )
+               ;
+         }
+
+         uint32_t chunk = etl::min( ms, max_chunk_ms );
+
+         slot->msg      = copy( slot->storage, msg );
+         slot->left_ms  = ms - chunk;
+         slot->periodic = periodic;
+         slot->timer.start( chunk * 1000, periodic );
+
+         return TimerHandle( slot - slots + 1, slot->serial );
+      }
+
+      stamp_t current_stamp()
+      {
+         return ( stamping and stamping_task == xTaskGetCurrentTaskHandle() ) ? stamping : 0;
+      }
+
+      void queued( stamp_t stamp )
+      {
+         Slot *slot = find_slot( stamp >> 8 );
+
+         taskENTER_CRITICAL();
+         ++slot->in_flight;
+         taskEXIT_CRITICAL();
+      }
+
+      bool dequeued( stamp_t stamp )
+      {
+         Slot *slot = find_slot( stamp >> 8 );
+
+         taskENTER_CRITICAL();
+         --slot->in_flight;
+         bool current = ( uint8_t( slot->serial ) == uint8_t( stamp ) );
+         taskEXIT_CRITICAL();
+
+         return current;
+      }
+   }  // namespace timed
+
+   void TimerHandle::cancel()
+   {
+      Slot *slot = find_slot( this->slot );
+
+      if ( slot == nullptr )
+      {
+         return;
+      }
+
+      taskENTER_CRITICAL();
+
+      bool mine = ( slot->serial == serial );
+
+      if ( mine )
+      {
+         // Drops the copies already queued too. Hold the slot until the timer is stopped
+         ++slot->serial;
+         ++slot->in_flight;
+         slot->armed = false;
+      }
+
+      taskEXIT_CRITICAL();
+
+      if ( mine )
+      {
+         slot->timer.stop();
+
+         taskENTER_CRITICAL();
+         --slot->in_flight;
+         taskEXIT_CRITICAL();
+      }
+   }
+
+   bool TimerHandle::is_pending() const
+   {
+      Slot *slot = find_slot( this->slot );
+
+      return slot and slot->serial == serial and slot->armed;
+   }
+
+   uint32_t TimerHandle::remaining_ms() const
+   {
+      Slot    *slot = find_slot( this->slot );
+      uint32_t left = 0;
+
+      taskENTER_CRITICAL();
+
+      if ( slot and slot->serial == serial and slot->armed )
+      {
+         left = slot->left_ms + ( slot->timer.remaining_us() + 999 ) / 1000;
+      }
+
+      taskEXIT_CRITICAL();
+
+      return left;
+   }
 }
@@ -28,6 +28,7 @@ SOFTWARE.
 #include <rtos.hpp>
 #include <typestring.hpp>
 
+#include "conf_ram.hpp"
 #include "console_server.hpp"
 #include "program_manager.hpp"
 #include "parser.hpp"
@@ -37,11 +38,35 @@ extern void console_putc(vt100::char_t);
 class Console
 {
    using TTerminal = vt100::Terminal<console_putc>;
-   using TConsoleServer = ConsoleServer<TTerminal>;
+   using TConsoleServer = ConsoleServer<TTerminal, cyclo::console_line_size, cyclo::console_history_size>;
    using optional_buffer_view_t = TConsoleServer::optional_buffer_view_t;
 
+   /** Console server parsing the line as it is typed */
+   class Server : public TConsoleServer
+   {
+      Parser &parser;
+
+   public:
+      explicit Server( Parser &parser ) : parser{ parser } {}
+
+      void consume( etl::string_view words ) override
+      {
+         auto had_error = parser.has_error();
+
+         parser.feed( words );
+
+         // Let the user know straight away
+         if ( parser.has_error() and not had_error )
+         {
+            TTerminal::ring_bell();
+         }
+      }
+
+      void restart() override { parser.start(); }
+   };
+
    ///< Console error buffer
-   etl::string<80> error_buffer;
+   etl::string<cyclo::console_error_size> error_buffer;
 
    ///< Console own program place holder during parsing
    Program temp_program;
@@ -50,15 +75,18 @@ class Console
    Parser parser;
 
    ///< Console server
-   ConsoleServer<TTerminal> server;
+   Server server;
 
    ///< THE program manager
    ProgramManager &program_manager;
 
-   ///< Copy of the last valid program string
-   TConsoleServer::buffer_t last_program;
+   ///< Copy of the last valid program
+   Program last_program;
+
+   ///< Its source text, or empty if the line did not fit
+   TConsoleServer::buffer_t last_text;
 
-   rtos::Task<typestring_is("console"), 256> task;
+   rtos::Task<typestring_is("console"), cyclo::console_stack> task;
 
 public:
    explicit Console( ProgramManager &);
@@ -76,6 +104,27 @@ protected:
 
    void show_help();
    void show_list();
+
+   ///< Print the stack usage of all the tasks, and the static allocations
+   void show_memory();
+
+   ///< Print the size of a static allocation
+   static void show_allocation( const char *name, size_t bytes );
+
+   ///< Print the stack usage of a task
+   static void show_stack_usage( const rtos::StackUsage &usage );
+
+   ///< Print the CPU load, context switches and stack headroom of all the tasks
+   void show_top();
+
+   ///< Print the statistics of a task
+   static void show_task_stats( const rtos::TaskStats &stats );
+
+   ///< Print an unsigned number, right aligned to the given width
+   static void show_number( uint32_t value, uint8_t width = 0 );
+
+   ///< Print a compiled program in the shortest form
+   void show_program( const Program &pgm );
 };
 
 
@@ -26,6 +26,9 @@ SOFTWARE.
  * Class to act as a Terminal server.
  * The physical input/output must be provided.
  * This terminal server supports a VT100 terminal, and provides history, delete, insertion etc.
+ * The words of the line can be consumed as they are typed (see consume). Once the line buffer
+ *  is full, the words consumed are dropped to make room, so a line can be longer than the buffer.
+ *  Such a line can only be edited from its end, and is not kept in the history.
  */
 
 #include "logger.h"
@@ -35,9 +38,9 @@ SOFTWARE.
 #include <cstdio>
 
 // include project-specific configuration
+#include "line_history.hpp"
 #include "vt100.hpp"
 
-#include <etl/circular_buffer.h>
 #include <etl/optional.h>
 #include <etl/string.h>
 #include <etl/string_view.h>
@@ -46,9 +49,11 @@ SOFTWARE.
 // Constant definitions
 //
 
-template<typename TTerminal, const size_t TBufferSize = 40, const size_t THistorySize = 10>
+template<typename TTerminal, const size_t TBufferSize = 40, const size_t THistoryBytes = 128>
 class ConsoleServer
 {
+   static_assert( TBufferSize <= UINT8_MAX, "The history stores the length of a line in a byte" );
+
 public:
    /** Native char type */
    using char_t = vt100::char_t;
@@ -60,8 +65,8 @@ public:
    using optional_buffer_view_t = etl::optional<etl::string_view>;
 
 protected:
-   /** History stack */
-   using history_t = etl::circular_buffer<buffer_t, THistorySize>;
+   /** History of the lines, in a ring of bytes */
+   using history_t = LineHistory<THistoryBytes>;
 
    /** Control of the history */
    enum class history_e : uint8_t {
@@ -81,10 +86,10 @@ protected:
    typename buffer_t::iterator input_buffer_position;
 
    /** Holds the history */
-   history_t history_buffer;
+   history_t history;
 
-   /** Hold the current input_buffer_position in the history */
-   typename history_t::iterator history_position;
+   /** Entry of the history recalled. history.size() for the line being typed */
+   uint8_t history_position;
 
    /** State of the input for control character */
    input_state_t input_state;
@@ -92,17 +97,40 @@ protected:
    /** To cope with CR and LF in different shells, skip if the char is this value */
    char_t skip_first_if;
 
+   /** Number of characters at the start of the buffer already consumed */
+   size_t consumed;
+
+   /** Set once consumed characters were dropped from the buffer */
+   bool truncated;
+
+   /** Set once [ENTER] is pressed. The line is kept until the next input */
+   bool entered;
+
 public:
    ConsoleServer()
       : input_buffer_position( input_buffer.begin() )
-      , history_position()
+      , history_position( 0 )
       , input_state( input_state_t::normal )
       , skip_first_if( '\0' )
+      , consumed( 0 )
+      , truncated( false )
+      , entered( false )
    {}
 
    virtual void print_prompt() { TTerminal::print_P( PSTR( "> " ) ); }
 
-   etl::string_view get_line() { return etl::string_view( history_buffer.back() ); }
+   /**
+    * Process the words of the line as they are typed.
+    * Called with the words completed each time a separator is appended to the line,
+    *  then with the rest of the line on [ENTER]. Does nothing by default.
+    */
+   virtual void consume( etl::string_view ) {}
+
+   /** The words consumed so far were edited, and will be consumed again */
+   virtual void restart() {}
+
+   /** The line being typed, or the line entered until the next input */
+   etl::string_view get_line() { return etl::string_view( input_buffer ); }
 
    /**
     * Reset the internal state machine if the input is interrupted
@@ -110,8 +138,9 @@ public:
    void reset()
    {
       input_state = input_state_t::normal;
-      input_buffer.clear();
+      new_line();
       skip_first_if = 0;
+      restart();
    }
 
    // process the received character
@@ -119,6 +148,11 @@ public:
    {
       etl::optional<etl::string_view> retval;
 
+      if ( entered )
+      {
+         new_line();
+      }
+
       // Once - Skip a LF following a CR or vice versa
       if ( c == skip_first_if )
       {
@@ -135,6 +169,15 @@ public:
       {
       case input_state_t::cmd:
          // We have already received ESC and [ - now process the vt100 code
+         input_state = input_state_t::normal;
+
+         // The start of a truncated line is no longer in the buffer - so it cannot be edited
+         if ( truncated )
+         {
+            TTerminal::ring_bell();
+            return retval;
+         }
+
          switch ( c )
          {
          case vt100::arrow::up: do_history( history_e::prev ); break;
@@ -191,9 +234,6 @@ public:
          default: break;
          }
 
-         // done, reset state
-         input_state = input_state_t::normal;
-
          return retval;
       case input_state_t::esc:
          // we last received [ESC]
@@ -216,8 +256,21 @@ public:
       if ( ( c >= '\x20' ) && ( c < '\x7f' ) )
       {
          // character is printable
+         // if the buffer is full, make room by dropping the words consumed
+         if ( input_buffer.full() and consumed and input_buffer_position == input_buffer.end() )
+         {
+            input_buffer.erase( input_buffer.begin(), input_buffer.begin() + consumed );
+            input_buffer_position = input_buffer.end();
+            consumed              = 0;
+            truncated             = true;
+         }
+
          // is this a simple append
-         if ( input_buffer.available() )
+         if ( not input_buffer.available() )
+         {
+            TTerminal::ring_bell();
+         }
+         else if ( can_edit( input_buffer_position ) )
          {
             if ( input_buffer_position == input_buffer.end() )
             {
@@ -229,6 +282,13 @@ public:
 
                // Move the position along
                ++input_buffer_position;
+
+               // A word is complete
+               if ( c == ' ' or c == ',' )
+               {
+                  consume( etl::string_view( input_buffer.begin() + consumed, input_buffer.end() ) );
+                  consumed = input_buffer.size();
+               }
             }
             else
             {
@@ -247,10 +307,6 @@ public:
                TTerminal::move_back( input_buffer.end() - input_buffer_position );
             }
          }
-         else
-         {
-            TTerminal::ring_bell();
-         }
       }
       // handle special characters - LineFeed or CarriageReturn?
       else if ( c == ascii::lf or c == ascii::cr )
@@ -263,9 +319,19 @@ public:
 
          if ( not input_buffer.empty() )
          {
-            // Store the last (non-empty) line in the history
-            do_history( history_e::save );
-            retval = get_line();
+            consume( etl::string_view( input_buffer.begin() + consumed, input_buffer.end() ) );
+
+            if ( truncated )
+            {
+               // Only the end of the line is known
+               retval = etl::string_view();
+            }
+            else
+            {
+               // Store the last (non-empty) line in the history
+               do_history( history_e::save );
+               retval = get_line();
+            }
          }
          else
          {
@@ -273,7 +339,9 @@ public:
             retval = etl::string_view();
          }
 
-         // reset buffer
+         // The buffer is reset on the next input
+         entered = true;
+
          return retval;
       }
       else if ( c == ascii::del or c == ascii::bs )
@@ -282,7 +350,7 @@ public:
          {
             TTerminal::ring_bell();
          }
-         else
+         else if ( can_edit( input_buffer_position - 1 ) )
          {
             // is this a simple delete (off the end of the line)
             if ( input_buffer_position == input_buffer.end() )
@@ -320,6 +388,40 @@ public:
    }
 
 protected:
+   /**
+    * Check the character at the given position can be changed.
+    * If it was consumed, the consumed words are void, and consumed again later.
+    */
+   bool can_edit( typename buffer_t::iterator at )
+   {
+      if ( size_t( at - input_buffer.begin() ) >= consumed )
+      {
+         return true;
+      }
+
+      if ( truncated )
+      {
+         TTerminal::ring_bell();
+         return false;
+      }
+
+      consumed = 0;
+      restart();
+
+      return true;
+   }
+
+   /** Start a fresh line */
+   void new_line()
+   {
+      input_buffer.clear();
+      input_buffer_position = input_buffer.begin();
+      consumed              = 0;
+      truncated             = false;
+      entered               = false;
+      history_position      = history.size();
+   }
+
    void repaint( size_t erase_up_to = 0 )
    {
       TTerminal::move_to_start();
@@ -344,29 +446,14 @@ protected:
    {
       if ( action == history_e::save )
       {
-         // Don't add if already in the buffer - rather move last
-         // TODO
-         // auto it = history_buffer.find(input_buffer);
-         // if ( it == history_buffer.end() )
-         // Move history back
-
-         // Save
-         history_buffer.push( input_buffer );
-
-         // Points to the next available slot
-         history_position = history_buffer.end();
-
-         // Reset the buffer
-         input_buffer.clear();
-
-         // Reset the history position
-         input_buffer_position = input_buffer.begin();
+         // Save. A line already in the history is moved last
+         history.push( etl::string_view( input_buffer ) );
       }
       else
       {
          if ( action == history_e::next )
          {
-            if ( history_position != history_buffer.end() )
+            if ( history_position != history.size() )
             {
                ++history_position;
             }
@@ -378,7 +465,7 @@ protected:
          }
          else  // prev
          {
-            if ( history_position != history_buffer.begin() )
+            if ( history_position != 0 )
             {
                --history_position;
             }
@@ -389,11 +476,21 @@ protected:
             }
          }
 
+         // The whole line is replaced
+         can_edit( input_buffer.begin() );
+
          // Grab the number of characters to erase
          size_t char_erase_count = input_buffer.size();
 
-         // Copy the content into the buffer
-         input_buffer = *history_position;
+         // Copy the content into the buffer - or restore an empty line past the last
+         if ( history_position != history.size() )
+         {
+            history.copy( history_position, input_buffer );
+         }
+         else
+         {
+            input_buffer.clear();
+         }
 
          // Repaint and move cursor to the end
          input_buffer_position = input_buffer.end();
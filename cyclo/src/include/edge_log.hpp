@@ -0,0 +1,99 @@
+/******************************************************************************
+The MIT License(MIT)
+https://github.com/adarwoo/cyclo
+
+Copyright(c) 2021 Guillaume ARRECKX - software@arreckx.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+******************************************************************************/
+#ifndef edge_log_hpp_included
+#define edge_log_hpp_included
+/*
+ * Post-mortem history of the relay and NO/NC sense edges.
+ * A fixed size ring of compact records, written without locks from the
+ *  sequencer task and from the NO/NC sampling interrupt.
+ * The ring is dumped in one binary transfer by the 'edges' console command
+ *  and decoded on the host with tools/edges.py
+ */
+#include <cstddef>
+#include <cstdint>
+
+#include "conf_cyclo.hpp"
+
+
+namespace edge_log
+{
+   ///< Bump when the record or header layout changes
+   constexpr uint8_t version = 2;
+
+   ///< Flags of a record. The source is in the top bit, the level in the bottom one
+   enum flags_t : uint8_t {
+      relay_open  = 0x00,  ///< The sequencer opened the contact
+      relay_close = 0x01,  ///< The sequencer closed the contact
+      sense_nc    = 0x80,  ///< The NO/NC sense reads NC
+      sense_no    = 0x81,  ///< The NO/NC sense reads NO
+   };
+
+   ///< Step index used when the edge is not caused by a program step
+   constexpr uint8_t no_step = 0xff;
+
+   ///< A single edge. Little endian, as sent over the wire
+   struct __attribute__( ( packed ) ) Record
+   {
+      uint32_t timestamp_us;  ///< Free running micro-second timestamp (wraps every ~71mn)
+      uint8_t  flags;         ///< One of flags_t
+      uint8_t  step;          ///< Index of the program step or no_step
+   };
+
+   ///< Header preceding the records in a dump
+   struct __attribute__( ( packed ) ) Header
+   {
+      char     magic[ 4 ];    ///< 'CYED'
+      uint8_t  version;       ///< edge_log::version
+      uint8_t  record_size;   ///< sizeof(Record)
+      uint8_t  count;         ///< Number of records following, oldest first
+      uint8_t  reserved;
+      uint16_t total;         ///< Number of records ever written (modulo 2^16)
+      uint32_t now_us;        ///< Timestamp at the time of the dump
+      uint32_t first_edge_us; ///< Time from boot to the first edge ever written, 0 if none
+   };
+
+   static_assert( sizeof( Record ) == 6, "Records are sent as is to the host" );
+   static_assert( sizeof( Header ) == 18, "The header is sent as is to the host" );
+
+   static_assert(
+      ( cyclo::edge_log_size & ( cyclo::edge_log_size - 1 ) ) == 0 and cyclo::edge_log_size <= 128,
+      "The edge log size must be a power of 2, up to 128" );
+
+   ///< Take the boot time reference. Call from main, once the timebase runs
+   void start();
+
+   ///< Add an edge to the log. Safe from tasks and interrupts
+   void record( flags_t flags, uint8_t step = no_step );
+
+   ///< Current value of the edge timestamp
+   uint32_t now_us();
+
+   /**
+    * Send the whole log in one go, header first, then the records oldest first.
+    * @param write Raw write function of the transport
+    */
+   void dump( void ( *write )( const void *, size_t ) );
+}  // namespace edge_log
+
+
+#endif  // ndef edge_log_hpp_included
@@ -0,0 +1,180 @@
+/******************************************************************************
+The MIT License(MIT)
+https://github.com/adarwoo/cyclo
+
+Copyright(c) 2021 Guillaume ARRECKX - software@arreckx.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+******************************************************************************/
+#ifndef line_history_hpp_was_included
+#define line_history_hpp_was_included
+/**
+ * History of the command lines, for the console server.
+ * The lines are stored back to back in a ring of bytes, each prefixed by its length,
+ *  so short lines only take the room they need. The oldest lines are dropped to make
+ *  room for the new ones.
+ * Entries are numbered from 0 (the oldest) to size() - 1 (the most recent).
+ */
+#include <cstdint>
+
+#include <etl/string.h>
+#include <etl/string_view.h>
+
+template<const size_t TSize>
+class LineHistory
+{
+   // Each entry takes 2 bytes at least
+   static_assert( TSize > 1 and TSize / 2 <= UINT8_MAX, "Invalid history size" );
+
+   using index_t = uint16_t;
+
+   ///< The ring
+   char ring[ TSize ];
+
+   ///< Start of the oldest entry
+   index_t tail;
+
+   ///< Number of bytes used
+   index_t used;
+
+   ///< Number of entries
+   uint8_t count;
+
+   inline index_t wrap( size_t index ) const { return index % TSize; }
+
+   ///< @return The ring index of the given entry
+   index_t locate( uint8_t entry ) const
+   {
+      index_t at = tail;
+
+      while ( entry-- )
+      {
+         at = wrap( at + 1 + uint8_t( ring[ at ] ) );
+      }
+
+      return at;
+   }
+
+   ///< Check if an entry holds the given text
+   bool equals( index_t at, etl::string_view line ) const
+   {
+      if ( uint8_t( ring[ at ] ) != line.size() )
+      {
+         return false;
+      }
+
+      for ( auto c : line )
+      {
+         at = wrap( at + 1 );
+
+         if ( ring[ at ] != c )
+         {
+            return false;
+         }
+      }
+
+      return true;
+   }
+
+   ///< Remove an entry, moving the more recent ones down
+   void remove( uint8_t entry )
+   {
+      index_t to     = locate( entry );
+      index_t length = 1 + uint8_t( ring[ to ] );
+      index_t from   = wrap( to + length );
+      index_t head   = wrap( tail + used );
+
+      while ( from != head )
+      {
+         ring[ to ] = ring[ from ];
+         to         = wrap( to + 1 );
+         from       = wrap( from + 1 );
+      }
+
+      used -= length;
+      --count;
+   }
+
+public:
+   LineHistory() : tail{ 0 }, used{ 0 }, count{ 0 } {}
+
+   ///< @return The number of entries
+   inline uint8_t size() const { return count; }
+
+   /**
+    * Add a line as the most recent entry. If the same line is already
+    *  stored, it is moved rather than duplicated.
+    * Lines which cannot fit are ignored.
+    */
+   void push( etl::string_view line )
+   {
+      if ( line.empty() or line.size() >= TSize or line.size() > UINT8_MAX )
+      {
+         return;
+      }
+
+      for ( uint8_t entry = 0; entry < count; ++entry )
+      {
+         if ( equals( locate( entry ), line ) )
+         {
+            remove( entry );
+            break;
+         }
+      }
+
+      // Drop the oldest entries to make room
+      while ( TSize - used < 1 + line.size() )
+      {
+         index_t length = 1 + uint8_t( ring[ tail ] );
+
+         tail = wrap( tail + length );
+         used -= length;
+         --count;
+      }
+
+      index_t at = wrap( tail + used );
+
+      ring[ at ] = line.size();
+
+      for ( auto c : line )
+      {
+         at         = wrap( at + 1 );
+         ring[ at ] = c;
+      }
+
+      used += 1 + line.size();
+      ++count;
+   }
+
+   ///< Copy an entry into the given string (truncated to its capacity)
+   void copy( uint8_t entry, etl::istring &to ) const
+   {
+      index_t at     = locate( entry );
+      uint8_t length = ring[ at ];
+
+      to.clear();
+
+      while ( length-- and not to.full() )
+      {
+         at = wrap( at + 1 );
+         to.push_back( ring[ at ] );
+      }
+   }
+};
+
+
+#endif  // ndef line_history_hpp_was_included
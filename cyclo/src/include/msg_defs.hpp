@@ -26,6 +26,7 @@ SOFTWARE.
  * Defines all the fx messages
  */
 #include "asx.h"
+#include "conf_ram.hpp"
 
 #include <fx.hpp>
 #include <rtos.hpp>
@@ -51,6 +52,8 @@ namespace msg
    FX_MSG( USBConnected ){};
    FX_MSG( USBDisconnected ){};
    FX_MSG( SequenceNext ){};
+   FX_MSG( NvmWriteDone ){};
+   FX_MSG( RenderFrame ){};
    FX_MSG( CheckHealth )
    {
       void check() const
@@ -72,7 +75,16 @@ namespace msg
       USBConnected,
       USBDisconnected,
       SequenceNext,
+      NvmWriteDone,
+      RenderFrame,
       CheckHealth>;
+
+   // The threaded dispatchers (see conf_ram.hpp)
+   using sequencer_bus_t = fx::Dispatcher<
+      packet_t, typestring_is( "sq" ), cyclo::sequencer_stack, 1, cyclo::sequencer_queue_length>;
+
+   using ui_bus_t =
+      fx::Dispatcher<packet_t, typestring_is( "ui" ), cyclo::ui_stack, 1, cyclo::ui_queue_length>;
 }  // namespace msg
 
 #endif  // ndef msg_defs_hpp_included
\ No newline at end of file
@@ -0,0 +1,114 @@
+/******************************************************************************
+The MIT License(MIT)
+https://github.com/adarwoo/cyclo
+
+Copyright(c) 2021 Guillaume ARRECKX - software@arreckx.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+******************************************************************************/
+#ifndef nvm_writer_hpp_included
+#define nvm_writer_hpp_included
+/*
+ * Background eeprom writer
+ * Page writes take several ms each, during which the caller would block.
+ * Instead, the writes are queued as jobs and carried out by a low priority
+ *  task. A job can request a msg::NvmWriteDone notification once written.
+ * The eeprom is left mapped in between the jobs. It is read through a Reader,
+ *  which waits for the jobs posted so far, and holds the writer off until
+ *  destroyed. The data must be copied out before then.
+ * Posting while holding a Reader could deadlock, should the queue be full.
+ */
+#include <rtos.hpp>
+#include <typestring.hpp>
+
+#include "asx.h"
+#include "conf_cyclo.hpp"
+
+
+class NvmWriter
+{
+public:
+   ///< Eeprom operation of a job
+   enum op_t : uint8_t {
+      write_page,   ///< Erase and write a whole page
+      split_write,  ///< Write some bytes of a page without erasing
+      erase_page    ///< Erase a whole page
+   };
+
+   ///< A page operation
+   struct Job
+   {
+      op_t    op;
+      uint8_t page;
+      uint8_t offset;  ///< Split write only. Offset of the bytes in the page
+      uint8_t length;  ///< Split write only. Number of bytes to write
+      bool    notify;  ///< Publish msg::NvmWriteDone once done
+      uint8_t data[ EEPROM_PAGE_SIZE ];
+   };
+
+   ///< Access to the mapped eeprom, for the lifetime of the instance
+   class Reader
+   {
+      NvmWriter &nvm;
+
+   public:
+      explicit Reader( NvmWriter &nvm ) : nvm{ nvm } { nvm.lock(); }
+      ~Reader() { nvm.unlock(); }
+   };
+
+private:
+   ///< Jobs waiting
+   rtos::Queue<Job, cyclo::nvm_queue_length> queue;
+
+   ///< Held by the writer during a job, and by the readers
+   rtos::Mutex access;
+
+   ///< Given when all jobs are written
+   rtos::BinarySemaphore drained;
+
+   ///< Number of jobs posted but not written yet
+   volatile uint8_t pending;
+
+   ///< The writer task
+   rtos::Task<typestring_is( "nvm" ), cyclo::nvm_stack, rtos::priority_t::low> task;
+
+public:
+   NvmWriter();
+
+   /**
+    * Queue a job. Blocks if the queue is full.
+    * Before the scheduler starts, the job is carried out right away.
+    */
+   void post( Job &job );
+
+   ///< Wait for all queued jobs to be written
+   void sync();
+
+protected:
+   ///< Wait for the queued jobs, and hold the writer off. Used by the Reader
+   void lock();
+   void unlock();
+
+   ///< Carry out a job
+   void execute( const Job &job );
+
+   ///< Task entry point
+   void run();
+};
+
+
+#endif  // ndef nvm_writer_hpp_included
@@ -37,6 +37,8 @@ SOFTWARE.
  * Parser instance for parsing a program or the command line
  * The parser object can be reused, but will overwrite the
  *  supplied program and error.
+ * The line can be fed in several chunks as it is typed, with the parser resuming
+ *  where it stopped, so only the last chunk is left to parse once the line is complete.
  */
 class Parser
 {
@@ -53,18 +55,49 @@ public:
       run     = 'r',
       quit    = 'q',
       autostart = 'a',
+      edges   = 'e',
+      verify  = 'v',
+      memory  = 'm',
+      top     = 't',
    };
 
 // Local data
 protected:
+   ///< State of the token being scanned
+   struct Token
+   {
+      enum kind_t : uint8_t { none, number, word, other } kind;
+
+      uint8_t  start;   ///< Position of the first character in the line
+      uint8_t  length;  ///< Number of characters so far
+      uint8_t  digits;  ///< Leading digits of a number
+      uint8_t  match;   ///< Unit index of a number, or keyword index of a word (+1, 0 if none)
+      uint32_t value;   ///< Value of a number
+
+      ///< Beginning of the token, to quote in the error messages
+      char text[ 12 ];
+
+      ///< @return The beginning of the token kept
+      etl::string_view kept() const { return etl::string_view( text, etl::min<size_t>( length, sizeof( text ) ) ); }
+   };
+
    ///< Reference to the program to construct
    Program                          &live_;
 
    ///< Storage for the error message
    etl::istring                     &err_;
 
-   ///< Internal buffer
-   etl::string_view::const_iterator buffer_;
+   ///< Token being scanned
+   Token token_;
+
+   ///< Result so far
+   Result result_;
+
+   ///< What is expected next
+   uint8_t expects_;
+
+   ///< Position of the next character in the line
+   uint8_t position_;
 
    ///< Position of the error
    uint8_t distance;
@@ -82,6 +115,21 @@ public:
    ///< Access the program number. Guaranteed since the manual program always exists. Can be zero if the program is off.
    int8_t get_program_number() { return program_number; }
 
+   ///< @return true if the line fed so far is already in error
+   bool has_error() const { return not err_.empty(); }
+
+   ///< Start a new line
+   void start();
+
+   ///< Parse the next characters of the line
+   void feed( const etl::string_view &chunk );
+
+   /**
+    * Complete the line
+    * @return The parser result
+    */
+   Result finish();
+
    /**
     * Parse a single line passed as a string_view buffer
     * @return The parser result
@@ -90,28 +138,14 @@ public:
 
 // Helpers
 protected:
-   ///< Check if the token is a delay
-   bool get_delay( uint32_t &value, const etl::string_view token );
-
-   ///< Get the expected program number from the token
-   bool parse_program_number( const etl::string_view token );
+   ///< Process the token once complete
+   void accept();
 
    ///< Build the program checking for error conditions
-   void safe_insert( Command::command_t c, etl::string_view token );
+   void safe_insert( Command::command_t c );
 
-   ///< Compute the error distance
-   template<typename T>
-   void error( T where )
-   {
-      if constexpr ( etl::is_same_v<T, etl::string_view> )
-      {
-         distance = where.begin() - buffer_;
-      }
-      else if constexpr ( etl::is_pointer_v<T> )
-      {
-         distance = where - buffer_;
-      }
-   }
+   ///< Report the token as unexpected, quoted after the given text, from the given offset
+   void unexpected( const char *prefix, uint8_t offset = 0 );
 };
 
 
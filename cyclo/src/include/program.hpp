@@ -29,10 +29,9 @@ SOFTWARE.
  * Created: 06/08/2021 23:15:28
  *  Author: software@arreckx.com
  */
+#include <cstddef>
 #include <cstdint>
 
-#include <etl/vector.h>
-
 #include "conf_cyclo.hpp"
 
 
@@ -43,49 +42,157 @@ SOFTWARE.
  */
 struct Command
 {
-   ///< Program for the engine
-   enum command_t : char { open = 'o', close = 'c', delay = 'd', loop = 'l' } command;
+   ///< Program for the engine. Stored in a nibble, and 0 is never a command
+   enum command_t : uint8_t { open = 1, close, delay, loop } command;
 
-   ///< Delay after the command execution
-   uint32_t delay_ms;
+   ///< Delay after the command execution, in program ticks
+   uint32_t ticks;
 
    ///< Simple constructor
-   explicit Command( command_t type, uint32_t delay = 0 ) : command{ type }, delay_ms{ delay }
+   explicit Command( command_t type, uint32_t ticks = 0 ) : command{ type }, ticks{ ticks }
    {}
+
+   ///< Convert a delay in ms to ticks, rounding up so a delay is never lost
+   static constexpr uint32_t to_ticks( uint32_t ms )
+   {
+      return ms / cyclo::ms_per_tick + ( ms % cyclo::ms_per_tick != 0 );
+   }
+
+   ///< @return The delay in ms
+   inline uint32_t delay_ms() const { return ticks * cyclo::ms_per_tick; }
 };
 
 
 /**
- * Holds a complete program already parsed
+ * Holds a complete program already parsed, packed as a stream of bytes.
+ * Each step starts with a byte holding the command in the high nibble, and the
+ *  3 low bits of the delay. Bit 3 is set if more bits of the delay follow, 7 bits
+ *  per byte, least significant first, with the top bit set if more follow.
+ * So a step without a delay takes 1 byte, and a step of up to 20 minutes 3 bytes.
  */
-class Program : public etl::vector<Command, cyclo::max_items_per_command>
+class Program
 {
-   // Easy iterator
-   const_iterator it;
+public:
+   ///< Size of the largest step (a 32 bits delay)
+   static constexpr uint8_t max_step_size = 6;
+
+   static_assert( cyclo::program_size <= UINT8_MAX, "The offsets are 8 bits" );
+
+   /**
+    * Forward iterator over the steps. Commands are decoded on the fly.
+    */
+   class const_iterator
+   {
+      const uint8_t *at;
+      uint8_t        step;
+
+   public:
+      const_iterator( const uint8_t *at, uint8_t step ) : at{ at }, step{ step } {}
+
+      inline Command operator*() const { return decode( at ); }
+
+      ///< @return The number of the step, from 0
+      inline uint8_t index() const { return step; }
+
+      inline const_iterator &operator++()
+      {
+         at += size_of( at );
+         ++step;
+
+         return *this;
+      }
+
+      inline const_iterator operator++( int )
+      {
+         auto retval = *this;
+         ++( *this );
+
+         return retval;
+      }
+
+      inline bool operator==( const const_iterator &other ) const { return at == other.at; }
+      inline bool operator!=( const const_iterator &other ) const { return at != other.at; }
+
+      friend class Program;
+   };
+
+private:
+   ///< The packed steps
+   uint8_t code[ cyclo::program_size ];
+
+   ///< Number of bytes used
+   uint8_t length;
+
+   ///< Number of steps
+   uint8_t steps;
+
+   ///< Offset of the last step
+   uint8_t last;
+
+   ///< Offset and number of the next step to execute. Offsets so copies are safe
+   uint8_t cursor;
+   uint8_t cursor_step;
+
+   ///< Pack a step. @return The number of bytes written
+   static uint8_t encode( const Command &cmd, uint8_t *to );
+
+   ///< Unpack the step at the given position
+   static Command decode( const uint8_t *at );
+
+   ///< @return The number of bytes of the step at the given position
+   static uint8_t size_of( const uint8_t *at );
 
 public:
-   // Program
-   Program() : it{ begin() } {}
+   Program() : length{ 0 }, steps{ 0 }, last{ 0 }, cursor{ 0 }, cursor_step{ 0 } {}
+
+   inline const_iterator begin() const { return const_iterator{ code, 0 }; }
+   inline const_iterator end() const { return const_iterator{ code + length, steps }; }
+
+   ///< @return The number of steps
+   inline uint8_t size() const { return steps; }
+
+   ///< @return The number of bytes used
+   inline uint8_t bytes() const { return length; }
+
+   inline const uint8_t *data() const { return code; }
+   inline bool           empty() const { return length == 0; }
+
+   ///< @return The last step. The program must not be empty
+   inline Command back() const { return decode( code + last ); }
+
+   void clear() { length = steps = last = cursor = cursor_step = 0; }
+
+   /** Append a step. @return false if there is no room */
+   bool push_back( const Command &cmd );
+
+   /** Add to the delay of the last step. @return false if there is no room */
+   bool add_delay( uint32_t ticks );
+
+   /** Check packed steps, as given by data(), before use. @return false if not valid */
+   static bool check( const uint8_t *from, uint8_t size );
+
+   /** Replace the content with packed steps, as given by data(). @return false if not valid */
+   bool assign( const uint8_t *from, uint8_t size );
 
    /**
-    * Get the next item. This is the first item following a reset.
-    * Automatically loops the sequence for looped commands
-    * @returns A pointer to the next command to execute or nullptr if
-    *           the command has ended.
+    * Get the next step to execute. This is the first step following a start.
+    * @returns An iterator to the step, or end() once the program has ended.
     */
-   auto iterate()
+   const_iterator next()
    {
-      const Command *retval = nullptr;
+      const_iterator retval{ code + cursor, cursor_step };
 
-      if ( it != end() )
+      if ( cursor != length )
       {
-         retval = &( *it++ );
+         cursor += size_of( code + cursor );
+         ++cursor_step;
       }
 
       return retval;
    }
 
-   void start() { it = begin(); }
+   ///< Start the sequence from the first step
+   void start() { cursor = cursor_step = 0; }
 };
 
 
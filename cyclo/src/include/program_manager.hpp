@@ -31,16 +31,28 @@ SOFTWARE.
  * -------------------------
  * The EEProm is divided into a entry allocation table made of fixed sized items, pointing
  *  to variable size items
+ * Page 0 is the allocation table. Each entry gives the first page and the number of
+ *  pages of a program. Pages 1 to 4 hold a journal of the settings (auto-start, last used),
+ *  where each change appends a 4 bytes record, spreading the wear over the pages. Each
+ *  journal page starts with a format magic, so the data of older firmwares is never read
+ *  as a record. Such pages are erased by the scan.
+ * The remaining pages are allocated first fit to the programs, stored compiled, followed
+ *  by the optional source text. The allocation table is written last, so a program is
+ *  only replaced once its new copy is complete.
+ * The allocation table is cached in RAM along with the size and CRC of each program. It is
+ *  built once at boot and kept up to date on each write, so browsing the programs never
+ *  reads the eeprom. A full rescan is only done on request.
  *
  * Created: 17/07/2021 18:22:20
  *  Author: micro
  */
 #include "contact.hpp"
-#include "parser.hpp"
+#include "nvm_writer.hpp"
 #include "program.hpp"
 #include "trace.h"
 
 #include <etl/bitset.h>
+#include <etl/string.h>
 #include <etl/string_view.h>
 
 #include "conf_cyclo.hpp"
@@ -56,16 +68,20 @@ class ProgramManager
 {
 public:
    /** A bitset which determine which slot contains a valid program */
-   using Pgms = etl::bitset<10>;
+   using Pgms = etl::bitset<cyclo::max_programs>;
 
    /** The state of the active program  */
    enum program_state_t : uint8_t { stopped, paused, running, usb };
 
-   /** The program mode */
-   enum class mode_t : uint8_t { normal=0, autostart=0x50, lastused=0x0A };
-
-   /** The storage for the program must fit 2 pages of eeprom - header, spare and crc (2 bytes) */
-   static constexpr size_t STORAGE_MAX_LENGTH = ( EEPROM_PAGE_SIZE * 2 ) - 4;
+   /** Cached entry of the allocation table. Only meaningful if the slot is occupied */
+   struct Slot
+   {
+      uint8_t  first_page;  ///< First page of the program
+      uint8_t  page_count;  ///< Number of pages allocated
+      uint8_t  length;      ///< Number of bytes of the packed steps
+      uint8_t  text_len;    ///< Length of the source text (0 if none)
+      uint16_t crc;         ///< CRC of the stored program
+   };
 
 private:
    ///< Current selected program. 0 is auto. -1 is none.
@@ -86,17 +102,33 @@ private:
    /** Bit field containing program slots taken */
    Pgms occupancy_map;
 
+   ///< RAM copy of the allocation table
+   Slot directory[ cyclo::max_programs ];
+
+   ///< Next slot to write in the settings journal
+   uint8_t journal_next;
+
+   ///< Sequence number of the next journal record
+   uint8_t journal_seq;
+
    // Create the contact manager
    Contact contact;
 
-   ///< Avoid a race between the UI, the console and the sequencer
+   ///< Avoid a race between the loaders, and between the writers of the directory (UI
+   ///<  and console). The sequencer never waits on it. Take it before the eeprom reader
    rtos::Mutex lock;
 
-   ///< Copy of the active program
-   Program active_program;
+   ///< Active program, double buffered. Loaders fill the one the sequencer does not use
+   Program programs[ 2 ];
+
+   ///< Index of the most recently loaded program
+   volatile uint8_t published;
 
-   ///< Parser instance used when loading a program. Allow reuse, and save the stack
-   Parser parser;
+   ///< Index of the program used by the sequencer
+   volatile uint8_t acquired;
+
+   ///< All eeprom writes go through the background writer
+   NvmWriter nvm;
 
 public:
    ProgramManager();
@@ -127,32 +159,41 @@ public:
    // Grab the contact manager
    inline Contact &get_contact() { return contact; }
 
-   // Grab the program
-   inline Program &get_active_program() { return active_program; }
+   // Grab the most recently loaded program. The sequencer must use acquire()
+   inline const Program &get_active_program() const { return programs[ published ]; }
+
+   /** Grab the program to execute. For the sequencer only, in between steps */
+   Program &acquire();
 
    // Grab the map
    inline Pgms get_map() { return occupancy_map; }
 
+   // Grab the cached entry of a program
+   inline const Slot &get_slot( uint8_t index ) const { return directory[ index ]; }
+
    /** Grab the next available slot from the given position */
    int8_t get_next( int8_t from );
 
    /** Grab the prev available slot from the given position*/
    int8_t get_prev( int8_t from );
 
-   /** Get the program string at the given index */
-   const char *get_pgm( uint8_t index );
+   /** Copy the program source text at the given index. @return false if not stored */
+   bool get_text( uint8_t index, etl::istring &text );
+
+   /** Copy the program at the given index. @return false if no valid program */
+   bool read( uint8_t index, Program &pgm );
 
-   /** Write the given program at the given slot. 0 is the auto slot */
-   void write_pgm_at( uint8_t pos, etl::string_view view);
+   /** Write the given program at the given slot, with its optional text. 0 is the auto slot */
+   bool write_pgm_at( uint8_t pos, const Program &pgm, etl::string_view text = {} );
 
    /** Load a program from the eeprom - and start it */
    void load( uint8_t pgmIndex );
 
-   /** Load a program and start it */
-   void load( const Program &pgm );
+   /** Load a program and optionally start it */
+   void load( const Program &pgm, bool start = true );
 
-   /** Scan the whole eeprom for valid programs */
-   void scan();
+   /** Rebuild the directory from the eeprom, checking all programs. @return The number of entries dropped */
+   uint8_t scan();
 
    /** Set a program has auto start */
    void set_autostart( int8_t index );
@@ -170,15 +211,36 @@ public:
    void erase( uint8_t pgmIndex );
 
 protected:
+   ///< Grab the program buffer the sequencer does not use, to load it
+   Program &claim();
+
+   ///< Hand over a loaded program to the sequencer
+   inline void publish( const Program &pgm ) { published = &pgm - programs; }
+
+   ///< Address of a page in the mapped eeprom. Only valid while holding a NvmWriter::Reader
    template<typename T>
-   T *pgm_mapped_at( size_t pgmIndex )
+   T *mapped_at( uint8_t page )
    {
-      void *address = reinterpret_cast<void *>( pgm_at( pgmIndex ) + MAPPED_EEPROM_START );
+      void *address = reinterpret_cast<void *>( page * EEPROM_PAGE_SIZE + MAPPED_EEPROM_START );
 
       return static_cast<T *>( address );
    }
 
-   eeprom_addr_t pgm_at( const size_t index ) { return EEPROM_PAGE_SIZE * index * 2; }
+   ///< Find room for a program. @return The first page or -1 if the eeprom is full
+   int8_t allocate( uint8_t page_count, int8_t reusable );
+
+   ///< Write the allocation table from its RAM copy
+   void write_directory();
+
+   ///< Restore the auto-start and last-used settings from the journal
+   ///< @return A mask of the journal pages holding foreign data, to erase
+   uint8_t read_journal();
+
+   ///< Erase the journal pages of the mask
+   void erase_journal( uint8_t pages );
+
+   ///< Persist the auto-start and last-used settings in the journal
+   void write_settings();
 };
 
 
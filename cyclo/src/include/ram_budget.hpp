@@ -0,0 +1,44 @@
+/******************************************************************************
+The MIT License(MIT)
+https://github.com/adarwoo/cyclo
+
+Copyright(c) 2021 Guillaume ARRECKX - software@arreckx.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+******************************************************************************/
+#ifndef ram_budget_hpp_was_included
+#define ram_budget_hpp_was_included
+/**
+ * The static allocations, and what they cost in RAM.
+ * The sizes are set in conf_ram.hpp. The total is checked against the budget
+ *  at compile time.
+ */
+#include <cstddef>
+
+#include <etl/delegate.h>
+
+namespace ram_budget
+{
+   ///< Report function, given the name of an allocation in program memory and its size
+   using report_t = etl::delegate<void( const char *name, size_t bytes )>;
+
+   ///< Pass each allocation to the report function, then the total and the budget
+   void report( report_t report );
+}  // namespace ram_budget
+
+
+#endif  // ndef ram_budget_hpp_was_included
@@ -34,8 +34,6 @@ SOFTWARE.
 #include "program_manager.hpp"
 
 
-using namespace rtos::tick;
-
 
 class SequencerWorker
    : public fx::Worker<
@@ -45,17 +43,11 @@ class SequencerWorker
         msg::StopProgram,
         msg::SequenceNext>
 {
-   ///< Timer in between sequences
-   rtos::Timer<typestring_is( "tseq" ), uint32_t> timer;
-
-   ///< Prevent race - associate a count to each timer run
-   uint32_t timer_counter;
-
-   ///< Store the time left when resuming from pause
-   rtos::tick_t ticks_left;
+   ///< The next step, published once the delay has elapsed
+   fx::TimerHandle next_step;
 
-   ///< Local copy of the program to avoid race
-   Program program;
+   ///< Store the time left in ms when resuming from pause
+   uint32_t ms_left;
 
    ///< Access to the command manager
    ProgramManager &pgm_man;
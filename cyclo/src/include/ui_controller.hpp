@@ -33,6 +33,17 @@ SOFTWARE.
 
 namespace sml = boost::sml;
 
+/*
+ * Dispatch policy of the UI controller: jump_table (the sml default), branch_stm, switch_stm or
+ *  fold_expr. They trade code size for speed differently, and the jump tables are held in RAM
+ *  on the AVR. Select with make UI_SM_DISPATCH=<policy>, and compare with tools/sml_bench.cpp
+ */
+#ifndef UI_SM_DISPATCH
+#   define UI_SM_DISPATCH jump_table
+#endif
+
+using ui_dispatch_policy = sml::back::policies::UI_SM_DISPATCH;
+
 // Create those simple events
 struct up
 {};
@@ -29,19 +29,38 @@ SOFTWARE.
  * Author : software@arreckx.com
  */
 #include "ui_model.hpp"
+#include "ui_widget.hpp"
 
 
 class UIView
 {
    UIModel &model;
 
+   ///< Areas of the main screen, holding what they show
+   Widget<uint16_t> prog;      ///< Program index and highlight
+   Widget<uint8_t>  walkman;   ///< Program state and selection
+   Widget<int32_t>  counter;   ///< Cycle counter
+   Widget<bool>     contact;   ///< Contact opened
+   Widget<bool>     nonc;      ///< Normally opened
+
+   ///< To call when the whole screen is drawn over
+   void invalidate();
+
 public:
    ///< Use with manual_program_draw_digit
    enum show_digit_t : uint8_t { first_normal, first_highlight, next_highlight, back_to_normal };
 
    explicit UIView( UIModel &model );
 
+   ///< Send the changes to the display. Drawing only updates the framebuffer
+   void flush();
+
+   ///< Draw the whole main screen
    void draw();
+
+   ///< Redraw the counter and contact areas if their model value has changed
+   void compose();
+
    void draw_splash();
    void draw_prog( bool highlight = false );
    void draw_contact();
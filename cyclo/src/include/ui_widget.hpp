@@ -0,0 +1,67 @@
+/******************************************************************************
+The MIT License(MIT)
+https://github.com/adarwoo/cyclo
+
+Copyright(c) 2021 Guillaume ARRECKX - software@arreckx.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+******************************************************************************/
+#ifndef ui_widget_hpp_was_included
+#define ui_widget_hpp_was_included
+/**
+ * Retained state of an area of the screen.
+ * A widget remembers the value it was last drawn with, so the view only
+ *  redraws an area when the value shown actually changes.
+ * Anything drawing over the area (like clearing the screen) must invalidate
+ *  the widget, so it is drawn again the next time round.
+ */
+
+template<typename T>
+class Widget
+{
+   ///< Value last drawn
+   T shown;
+
+   ///< False if the screen no longer shows the value
+   bool valid;
+
+public:
+   Widget() : shown{}, valid{ false } {}
+
+   ///< Force the next update to draw
+   inline void invalidate() { valid = false; }
+
+   /**
+    * Check the value to show against the one on the screen.
+    * @return true if the widget must be drawn. The value is then taken as shown
+    */
+   bool update( const T &value )
+   {
+      if ( valid and shown == value )
+      {
+         return false;
+      }
+
+      shown = value;
+      valid = true;
+
+      return true;
+   }
+};
+
+
+#endif  // ndef ui_widget_hpp_was_included
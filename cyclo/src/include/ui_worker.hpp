@@ -53,12 +53,14 @@ class UIWorker
         msg::CounterUpdate,
         msg::USBConnected,
         msg::USBDisconnected,
-        msg::ProgramIsStopped>
+        msg::ProgramIsStopped,
+        msg::NvmWriteDone,
+        msg::RenderFrame>
 {
-   using UIController = sml::sm<sm_cyclo>;
+   using UIController = sml::sm<sm_cyclo, sml::dispatch<ui_dispatch_policy>>;
 
-   // Timer for the splash screen
-   rtos::Timer<typestring_is( "tsplash" )> splash_timer;
+   // Holds back the redraws caused by the program activity to the frame rate
+   fx::TimerHandle next_frame;
 
    // MVC instances. The model is only a facade
    UIModel      model;
@@ -77,6 +79,9 @@ public:
    // @return true if the main state machine is in USB state
    bool usb_is_on();
 
+   // Have the changes to the model drawn with the next frame
+   void request_frame();
+
    // --------------------------------------------------------------
    // Message handlers
    // --------------------------------------------------------------
@@ -89,6 +94,8 @@ public:
    void on_receive( const msg::USBConnected& );
    void on_receive( const msg::USBDisconnected& );
    void on_receive( const msg::ProgramIsStopped& );
+   void on_receive( const msg::NvmWriteDone& );
+   void on_receive( const msg::RenderFrame& );
 };
 
 
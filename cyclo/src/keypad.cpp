@@ -27,6 +27,7 @@ SOFTWARE.
 
 #include <FreeRTOS.h>
 #include <string.h>
+#include <timebase.hpp>
 
 #include "asx.h"
 
@@ -122,7 +123,8 @@ is in Hertz */
 /** Called with the timer interrupt to sample the keys */
 static void keypad_process( void )
 {
-   uint8_t i;
+   rtos::IsrProbe probe;
+   uint8_t        i;
 
    for ( i = 0; i < KEYPAD_NUMBER_OF_KEYS; ++i )
    {
@@ -29,8 +29,10 @@ SOFTWARE.
  */
 #include "asx.h"
 #include "console.hpp"
+#include "edge_log.hpp"
 
 #include <fx.hpp>
+#include <timebase.hpp>
 
 #include "keypad_tasklet.hpp"
 #include "nonc_tasklet.hpp"
@@ -48,22 +50,45 @@ int main( void )
    // Initialise the board hardware (clocks, IOs, buses etc.)
    board_init();
 
+   // Start the microsecond timebase, used by the hardware timers
+   rtos::start_timebase();
+   edge_log::start();
+
    // Create the 'programs' manager required throughout
    auto pgm_manager = ProgramManager{};
 
-   // Create the workers and their dispatchers
+   // Create the sequencer first, so an autostart program is not held up by the UI
    auto sequencer     = SequencerWorker{ pgm_manager };
-   auto sequencer_bus = fx::Dispatcher<msg::packet_t, typestring_is( "sq" ), 32>();
-   auto ui            = UIWorker{ pgm_manager };
-   auto ui_bus        = fx::Dispatcher<msg::packet_t, typestring_is( "ui" ), 128, 1, 8>();
+   auto sequencer_bus = msg::sequencer_bus_t{};
 
    ///< The root dispatcher (un-threaded) with 2 sub-dispatchers
    auto root = fx::RootDispatcher<2>();
 
    // Wire it all - add by priority order. The first added gets the messages first
    sequencer_bus << sequencer;
+   root << sequencer_bus;
+
+   // Fast boot - run the first step of the autostart program right away.
+   // The sequencer carries on once the scheduler is started
+   if ( pgm_manager.starts_automatically() )
+   {
+      pgm_manager.load( pgm_manager.get_autostart_index() );
+      pgm_manager.set_state( ProgramManager::running );
+      sequencer.on_receive( msg::StartProgram{ true } );
+   }
+
+   // The UI comes next, the display being slow to initialise
+   auto ui     = UIWorker{ pgm_manager };
+   auto ui_bus = msg::ui_bus_t{};
+
    ui_bus << ui;
-   root << sequencer_bus << ui_bus;
+   root << ui_bus;
+
+   // The counter update of the fast boot went out before the UI was wired
+   if ( pgm_manager.starts_automatically() )
+   {
+      fx::publish( msg::CounterUpdate{} );
+   }
 
    // Create the console task
    auto console = Console{ pgm_manager };
@@ -72,15 +97,8 @@ int main( void )
    auto key_tasklet  = KeypadTasklet{};
    auto nonc_tasklet = NoNcTasklet{ pgm_manager.get_contact() };
 
-   // Do we need to auto-start a program?
-   if ( pgm_manager.starts_automatically() )
-   {
-      fx::publish( msg::StartProgram{ true } );
-   }
-
-   // Start a repeating timer to have the watchdog kicked by a service
-   auto wdt = rtos::Timer<typestring_is( "wd" )>( []() { fx::publish( msg::CheckHealth() ); } );
-   wdt.start( 500_ms, true );
+   // Have the watchdog kicked by a service
+   fx::publish_every( msg::CheckHealth(), 500 );
 
    // Start the scheduler - and go! The tasklets, tasks and workers are now loose
    rtos::start_scheduler();
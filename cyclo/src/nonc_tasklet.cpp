@@ -30,6 +30,9 @@ SOFTWARE.
 #include "nonc_tasklet.hpp"
 
 #include "asx.h"
+#include "edge_log.hpp"
+
+#include <timebase.hpp>
 
 
 NoNcTasklet::NoNcTasklet( Contact &contact ) : contact{ contact }
@@ -53,6 +56,8 @@ NoNcTasklet::NoNcTasklet( Contact &contact ) : contact{ contact }
 void NoNcTasklet::read_nonc()
 {
    #ifndef _POSIX
+   rtos::IsrProbe probe;
+
    // Both sides are read
    // The state changes once the following is measured
    bool nc_readback = not ioport_get_pin_level( SWITCH_SENSE_NC );
@@ -67,6 +72,9 @@ void NoNcTasklet::read_nonc()
          initialised = true;
          was_no      = no_readback;
 
+         // Time stamp the edge from here, for accuracy
+         edge_log::record( no_readback ? edge_log::sense_no : edge_log::sense_nc );
+
          // Notify the initial status
          assert( this_ );
          // Get out of the IRQ quickly - and let the tasklet take over
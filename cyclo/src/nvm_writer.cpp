@@ -0,0 +1,167 @@
+/******************************************************************************
+The MIT License(MIT)
+https://github.com/adarwoo/cyclo
+
+Copyright(c) 2021 Guillaume ARRECKX - software@arreckx.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+******************************************************************************/
+/*
+ * Background eeprom writer
+ */
+#include "nvm_writer.hpp"
+
+#include <fx.hpp>
+
+#include "msg_defs.hpp"
+
+#include <logger.h>
+
+
+using namespace rtos::tick;
+
+namespace
+{
+   const char *const DOM = "nvm";
+
+   inline bool scheduler_is_running()
+   {
+      return xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED;
+   }
+}  // namespace
+
+
+NvmWriter::NvmWriter()
+   : pending{ 0 }
+   , task( etl::delegate<void()>::create<NvmWriter, &NvmWriter::run>( *this ) )
+{
+   // Mapped once and for all. The jobs map it back when done
+   eeprom_enable_mapping();
+}
+
+void NvmWriter::post( Job &job )
+{
+   // Early writes (during the construction of the objects) are synchronous
+   if ( not scheduler_is_running() )
+   {
+      execute( job );
+      return;
+   }
+
+   taskENTER_CRITICAL();
+   ++pending;
+   taskEXIT_CRITICAL();
+
+   queue.send( job );
+}
+
+void NvmWriter::sync()
+{
+   // The semaphore could have been taken by another waiting task - so poll too
+   while ( pending )
+   {
+      drained.take( 10_ms );
+   }
+}
+
+void NvmWriter::lock()
+{
+   // Before the scheduler starts, all the jobs are synchronous
+   if ( scheduler_is_running() )
+   {
+      // A job posted while waiting for the lock is waited for too
+      while ( true )
+      {
+         access.take();
+
+         if ( pending == 0 )
+         {
+            break;
+         }
+
+         access.give();
+         sync();
+      }
+   }
+}
+
+void NvmWriter::unlock()
+{
+   if ( scheduler_is_running() )
+   {
+      access.give();
+   }
+}
+
+void NvmWriter::execute( const Job &job )
+{
+   LOG_TRACE( DOM, "Job %d on page %d", job.op, job.page );
+
+   switch ( job.op )
+   {
+   case write_page:
+      nvm_eeprom_load_page_to_buffer( job.data );
+      nvm_eeprom_atomic_write_page( job.page );
+      break;
+   case split_write:
+      nvm_eeprom_flush_buffer();
+
+      for ( uint8_t i = 0; i < job.length; ++i )
+      {
+         nvm_eeprom_load_byte_to_buffer( job.offset + i, job.data[ i ] );
+      }
+
+      nvm_eeprom_split_write_page( job.page );
+      break;
+   case erase_page: nvm_eeprom_erase_page( job.page ); break;
+   }
+
+   // Make sure the data is in, so the eeprom can be read straight after
+   nvm_wait_until_ready();
+
+   // The ASF page functions leave the mapping off
+   eeprom_enable_mapping();
+}
+
+void NvmWriter::run()
+{
+   Job job;
+
+   while ( true )
+   {
+      queue.receive( job );
+
+      access.take();
+      execute( job );
+
+      taskENTER_CRITICAL();
+      bool done = ( --pending == 0 );
+      taskEXIT_CRITICAL();
+
+      access.give();
+
+      if ( done )
+      {
+         drained.give();
+      }
+
+      if ( job.notify )
+      {
+         fx::publish( msg::NvmWriteDone{} );
+      }
+   }
+}
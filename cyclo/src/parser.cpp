@@ -20,316 +20,469 @@ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
 OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 ******************************************************************************/
+#include "asx.h"
 #include "parser.hpp"
 
 #include "program.hpp"
 
-#include <etl/algorithm.h>
-#include <etl/basic_string.h>
-#include <etl/string.h>
-#include <etl/string_view.h>
-#include <etl/tokenizer.h>
-#include <etl/vector.h>
-
-#include <cctype>
+#include <etl/to_string.h>
 
 #include <logger.h>
 
-// Construct a parser
-Parser::Parser( Program &program, etl::istring &error )
-   : live_{ program }, err_( error ), buffer_{ nullptr }, distance{0}, program_number{-1}
-{}
-
-/**
- * Check if the token is a delay.
- * An error can be triggered
- *
- * @return 0 if not, otherwise the correct delay in ms
- */
-bool Parser::get_delay( uint32_t &value, const etl::string_view token )
+namespace
 {
-   using Item  = etl::pair<const char *, uint32_t>;
-   bool retval = false;
-
-   // Units conversion table
-   static constexpr Item unit_lut[] = {
-      { "H", 60ul * 60ul * 1000ul },
-      { "M", 60ul * 1000ul },
-      { "s", 1000 },
-      { "m", 1 },
-      { "", 1000 } };
-
-   // Check if the first char is a digit before perusing
-   if ( ::isdigit( token.front() ) )
+   const char *const DOM = "parser";
+
+   ///< What the parser expects next
+   enum expects_t : uint8_t { more, no_more, program, program_not_0, program_or_off };
+
+   /**
+    * A keyword. Any prefix of the name is accepted.
+    * The first letter of each keyword is unique, so the first letter of a token
+    *  is a perfect hash of the keyword it could be.
+    */
+   struct Keyword
    {
-      // Convert
-      auto unit_start = token.begin();
-      auto number     = strtoul( unit_start, const_cast<char **>( &unit_start ), 10 );
-      auto unit       = etl::string_view( unit_start, token.end() );
+      char           name[ 7 ];
+      char           command;  ///< Command to insert for the program keywords, or 0
+      Parser::Result result;
+      expects_t      expects;
+   };
+
+   constexpr Keyword keywords[] PROGMEM = {
+      { "open", Command::open, Parser::Result::program, more },
+      { "close", Command::close, Parser::Result::program, more },
+      { "help", 0, Parser::Result::help, no_more },
+      { "list", 0, Parser::Result::list, no_more },
+      { "edges", 0, Parser::Result::edges, no_more },
+      { "verify", 0, Parser::Result::verify, no_more },
+      { "memory", 0, Parser::Result::memory, no_more },
+      { "top", 0, Parser::Result::top, no_more },
+      { "quit", 0, Parser::Result::quit, no_more },
+      { "auto", 0, Parser::Result::autostart, program_or_off },
+      { "save", 0, Parser::Result::save, program_not_0 },
+      { "run", 0, Parser::Result::run, program },
+      { "delete", 0, Parser::Result::del, program_not_0 },
+   };
+
+   constexpr uint8_t KEYWORD_COUNT = sizeof( keywords ) / sizeof( keywords[ 0 ] );
+
+   ///< Units of the delays, and their value in ms. No unit means seconds
+   constexpr char     units[]   = "HMsm";
+   constexpr uint32_t unit_ms[] = { 1000, 60ul * 60ul * 1000ul, 60ul * 1000ul, 1000, 1 };
+
+   /**
+    * Class of each ASCII character.
+    * The letters starting a keyword hold its index + 1 in the low nibble,
+    *  the units their index + 1 in the high nibble. Other letters are 0.
+    */
+   enum : uint8_t {
+      OTHER        = 0,
+      KEYWORD_MASK = 0x0f,
+      UNIT_SHIFT   = 4,
+      UNIT_MASK    = 0x70,
+      SEPARATOR    = 0x80,
+      DIGIT        = 0x81,
+      STAR         = 0x82,
+   };
+
+   struct CharClasses
+   {
+      uint8_t of[ 128 ];
+   };
 
-      // Is it a program number rather?
-      if ( number < 10 and unit.size() == 0 )
+   constexpr CharClasses make_char_classes()
+   {
+      CharClasses table{};
+
+      table.of[ uint8_t( ' ' ) ] = SEPARATOR;
+      table.of[ uint8_t( ',' ) ] = SEPARATOR;
+      table.of[ uint8_t( '*' ) ] = STAR;
+
+      for ( char c = '0'; c <= '9'; ++c )
       {
-         program_number = number;
+         table.of[ uint8_t( c ) ] = DIGIT;
       }
 
-      auto foundit =
-         etl::find_if( etl::begin( unit_lut ), etl::end( unit_lut ), [ unit ]( const Item &i ) {
-            return unit == i.first;
-         } );
-
-      if ( foundit != etl::end( unit_lut ) )
+      for ( uint8_t i = 0; i < KEYWORD_COUNT; ++i )
       {
-         value  = number * foundit->second;
-         retval = true;
+         table.of[ uint8_t( keywords[ i ].name[ 0 ] ) ] = i + 1;
       }
-      else
+
+      for ( uint8_t i = 0; units[ i ]; ++i )
       {
-         err_ = "Invalid unit: '";
-         err_.append( unit.data(), unit.size() );
-         err_ += "\'";
-         error( unit_start );
+         table.of[ uint8_t( units[ i ] ) ] |= ( i + 1 ) << UNIT_SHIFT;
       }
+
+      return table;
    }
 
-   return retval;
-}
+   constexpr bool keywords_are_hashable()
+   {
+      for ( uint8_t i = 0; i < KEYWORD_COUNT; ++i )
+      {
+         for ( uint8_t j = 0; j < i; ++j )
+         {
+            if ( keywords[ i ].name[ 0 ] == keywords[ j ].name[ 0 ] )
+            {
+               return false;
+            }
+         }
+      }
 
-/**
- * @param token String containing the value to convert
- * @return true on success. If false, err_ contains the error descruption
- */
-bool Parser::parse_program_number( const etl::string_view token )
-{
-   auto retval = false;
+      return KEYWORD_COUNT <= KEYWORD_MASK;
+   }
 
-   // Mark as none
-   program_number = -1;
+   static_assert( keywords_are_hashable(), "Each keyword must start with a different letter" );
 
-   // Must be a single char 0->9
-   if ( not ::isdigit( token.front() ) or token.size() > 1 )
-   {
-      error(token);
-   }
-   else
+   constexpr CharClasses char_classes PROGMEM = make_char_classes();
+
+   inline uint8_t class_of( char c )
    {
-      program_number = token.front() - '0';
-      retval         = true;
+      return uint8_t( c ) < 128 ? pgm_read_byte( &char_classes.of[ uint8_t( c ) ] ) : uint8_t( OTHER );
    }
 
-   return retval;
+   ///< Marks an invalid unit
+   constexpr uint8_t BAD_UNIT = 0xff;
+
+   ///< Value of a number too large for 32 bits. Saturated, so it cannot wrap into range
+   constexpr uint32_t TOO_LARGE = UINT32_MAX;
+
+   ///< Longest delay of a step, so its length in ms still fits in 32 bits
+   constexpr uint32_t MAX_DELAY_TICKS = UINT32_MAX / cyclo::ms_per_tick;
+   constexpr uint32_t MAX_DELAY_MS    = MAX_DELAY_TICKS * cyclo::ms_per_tick;
+}  // namespace
+
+// Construct a parser
+Parser::Parser( Program &program, etl::istring &error )
+   : live_{ program }, err_( error ), distance{0}, program_number{-1}
+{
+   start();
 }
 
 /**
- * @param c Command to insert into the program
- * @param token Actual command element
+ * Reset the parser for a new line. The program and the error are cleared.
  */
-void Parser::safe_insert( Command::command_t c, etl::string_view token )
+void Parser::start()
 {
-   if ( live_.full() )
-   {
-      err_.assign( "Too many items" );
-      error( token );
-   }
-   else if ( live_.back().command == Command::loop )
-   {
-      err_.assign( "No commands allowed past *" );
-      error( token );
-   }
-   else if ( live_.empty() and c == Command::loop )
-   {
-      err_.assign( "Loop not allowed as first action" );
-      error( token );
-   }
-   else
-   {
-      if ( c != Command::delay )
-      {
-         // Force a 1 second delay unless given
-         if ( not live_.empty() and live_.back().delay_ms == 0 )
-         {
-            LOG_DEBUG( "parser", "Adding 1s delay" );
-            live_.back().delay_ms = 1000;
-         }
-      }
+   live_.clear();
+   err_.clear();
 
-      LOG_DEBUG( "parser", "Adding item: '%c'", c );
+   token_.kind = Token::none;
+   result_     = Result::program;  // Default is to expect a program
+   expects_    = more;
+   position_   = 0;
 
-      // Insert a new command
-      live_.push_back( Command( c ) );
-   }
+   // Invalidate the program number
+   program_number = -1;
 }
 
 /**
- * @param buffer The buffer to parse
- * @return A parsing can return an program, a interactive command, nothing
- *          or an error. The calling entity should switch case the result
- *          to process the result.
- *         If the result is error, the supplied error string will contain
- *          the error text description, along with the method get_error_position
- *          which can point to the actual location of the error in the supplied string.
- *         If the result is a command, and the command requires a program number,
- *          the accessor get_program_number will provide the value.
- *         An empty (or space only) string returns 'nothing'.
- *         Finally, a return value 'program' indicate the program is available from
- *          the supplied program object.
+ * Scan the characters, a token being processed as soon as it is complete.
+ * A token can span several chunks. Nothing is done once an error is found.
+ * @param chunk The next characters of the line
  */
-Parser::Result Parser::parse( const etl::string_view &buffer )
+void Parser::feed( const etl::string_view &chunk )
 {
-   enum : uint8_t { more, no_more, program, program_1_to_9, program_or_off } expects = more;
-
-
-   auto retval = Result::program; // Default is to expect a program
-
-   // Reset all to allow multiple calls
-   buffer_     = buffer.begin();
-   live_.clear();
-   err_.clear();
+   LOG_DEBUG( DOM, "Feeding: %.*s", (int)chunk.size(), chunk.data() );
 
-   // Invalidate the program number
-   program_number = 255;
+   auto pos  = chunk.begin();
+   auto end  = chunk.end();
+   auto base = position_;
 
-   LOG_INFO( "parser", "Parsing: %s", etl::string<60>( buffer ).c_str() );
+   // Keep the position within the line, saturated
+   position_ = etl::min<size_t>( base + chunk.size(), UINT8_MAX );
 
-   for ( auto token : etl::tokenizer( buffer, etl::char_separator( " ," ) ) )
+   while ( err_.empty() and pos != end )
    {
-      // Lambdas to scope things a bit
-      auto is_command = [ token ]( etl::string_view command ) {
-         return command.starts_with( token );
-      };
+      uint8_t cls;
 
-      // Check extra args
-      if ( expects == no_more )
+      if ( token_.kind == Token::none )
       {
-         err_ = "Unexpected extra arg(s): '";
-         err_.append( token.data(), token.size() );
-         err_ += "\'";
-         error( token );
-      }
+         while ( pos != end and class_of( *pos ) == SEPARATOR )
+         {
+            ++pos;
+         }
 
-      // Break on error
-      if ( not err_.empty() )
-      {
-         break;
-      }
+         if ( pos == end )
+         {
+            break;
+         }
 
-      uint32_t number;
+         cls = class_of( *pos );
 
-      if ( expects == program_or_off )
-      {
-         if ( (not parse_program_number(token)) and token != "off" )
+         token_.start  = etl::min<size_t>( base + ( pos - chunk.begin() ), UINT8_MAX );
+         token_.length = 0;
+         token_.digits = 0;
+         token_.value  = 0;
+         token_.match  = 0;
+
+         if ( cls == DIGIT )
+         {
+            token_.kind = Token::number;
+         }
+         else if ( cls != STAR and ( cls & KEYWORD_MASK ) )
          {
-            err_ = "Expecting the program number [0 to 9] or 'off'";
+            token_.kind  = Token::word;
+            token_.match = cls & KEYWORD_MASK;
          }
          else
          {
-            expects = no_more;
+            token_.kind = Token::other;
          }
       }
-      else if ( expects == program or expects == program_1_to_9 )
+
+      // Scan the rest of the token in the chunk
+      for ( ; pos != end and ( cls = class_of( *pos ) ) != SEPARATOR; ++pos )
       {
-         if ( not parse_program_number(token) )
-         {
-            err_ = "Expecting a number ";
+         auto c = *pos;
 
-            if ( expects == program )
+         if ( token_.kind == Token::number )
+         {
+            if ( cls == DIGIT and token_.digits == token_.length )
             {
-               err_ += '0';
+               token_.value = ( token_.value < ( TOO_LARGE - 9 ) / 10 ) ? token_.value * 10 + ( c - '0' ) : TOO_LARGE;
+               ++token_.digits;
+            }
+            else if ( token_.length == token_.digits and ( cls & UNIT_MASK ) )
+            {
+               token_.match = ( cls & UNIT_MASK ) >> UNIT_SHIFT;
             }
             else
             {
-               err_ += '1';
+               token_.match = BAD_UNIT;
             }
-
-            err_ += " to 9";
          }
-         else
+         else if ( token_.match )
          {
-            expects = no_more;
+            // Keep matching the keyword
+            auto *name = keywords[ token_.match - 1 ].name;
+
+            if ( token_.length >= sizeof( Keyword::name ) or c != (char)pgm_read_byte( &name[ token_.length ] ) )
+            {
+               token_.match = 0;
+            }
          }
-      }
-      else if ( get_delay( number, token ) )
-      {
-         if ( not live_.empty() )
-         {
-            LOG_DEBUG( "parser", "Adding %dms delay", number );
 
-            live_.back().delay_ms += number;
+         if ( token_.length < sizeof( token_.text ) )
+         {
+            token_.text[ token_.length ] = c;
          }
-         else
+
+         if ( token_.length < UINT8_MAX )
          {
-            safe_insert( Command::delay, token );
+            ++token_.length;
          }
       }
-      else if ( err_.empty() )
+
+      // The token is complete if a separator follows
+      if ( pos != end )
       {
-         if ( is_command( "open" ) )
-         {
-            safe_insert( Command::open, token );
-         }
-         else if ( is_command( "close" ) )
-         {
-            safe_insert( Command::close, token );
-         }
-         else if ( token == "*" )
+         accept();
+      }
+   }
+}
+
+/**
+ * Process the token just scanned
+ */
+void Parser::accept()
+{
+   auto is_program_number = token_.kind == Token::number and token_.length == token_.digits
+                            and token_.digits <= 2 and token_.value < cyclo::max_programs;
+
+   auto is_loop = token_.kind == Token::other and token_.length == 1 and token_.text[ 0 ] == '*';
+
+   if ( expects_ == no_more )
+   {
+      unexpected( "Unexpected extra arg(s): '" );
+   }
+   else if ( expects_ == program_or_off )
+   {
+      program_number = is_program_number ? int8_t( token_.value ) : int8_t( -1 );
+
+      if ( program_number < 0 and not ( token_.kept() == "off" ) )
+      {
+         err_ = "Expecting the program number [0 to ";
+         etl::to_string( cyclo::max_programs - 1, err_, true );
+         err_ += "] or 'off'";
+         distance = token_.start;
+      }
+
+      expects_ = no_more;
+   }
+   else if ( expects_ == program or expects_ == program_not_0 )
+   {
+      program_number = is_program_number ? int8_t( token_.value ) : int8_t( -1 );
+
+      // The manual program (0) cannot be saved over or deleted
+      if ( expects_ == program_not_0 and program_number == 0 )
+      {
+         program_number = -1;
+      }
+
+      if ( program_number < 0 )
+      {
+         err_ = "Expecting a number ";
+         err_ += expects_ == program ? '0' : '1';
+         err_ += " to ";
+         etl::to_string( cyclo::max_programs - 1, err_, true );
+         distance = token_.start;
+      }
+
+      expects_ = no_more;
+   }
+   else if ( token_.kind == Token::number and token_.match == BAD_UNIT )
+   {
+      unexpected( "Invalid unit: '", token_.digits );
+   }
+   else if ( token_.kind == Token::number and token_.value > MAX_DELAY_MS / unit_ms[ token_.match ] )
+   {
+      unexpected( "Delay too long: '" );
+   }
+   else if ( token_.kind == Token::number )
+   {
+      uint32_t delay = token_.value * unit_ms[ token_.match ];
+
+      // Is it a program number rather?
+      if ( is_program_number )
+      {
+         program_number = token_.value;
+      }
+
+      // A leading delay is a command of its own
+      if ( live_.empty() )
+      {
+         safe_insert( Command::delay );
+      }
+
+      if ( err_.empty() )
+      {
+         LOG_DEBUG( DOM, "Adding %lums delay", (unsigned long)delay );
+
+         uint32_t ticks = Command::to_ticks( delay );
+
+         // The delays following a command add up
+         if ( ticks > MAX_DELAY_TICKS - live_.back().ticks )
          {
-            // Loop - must be the last command
-            safe_insert( Command::loop, token );
+            unexpected( "Delay too long: '" );
          }
-         else
+         else if ( not live_.add_delay( ticks ) )
          {
-            if ( not live_.empty() )
-            {
-               err_ = "Unexpected: '";
-               err_.append( token.data(), token.size() );
-               err_ += "\'";
-               error( token );
-            }
-            else if ( is_command( "help" ) )
-            {
-               retval  = Result::help;
-               expects = no_more;
-            }
-            else if ( is_command( "list" ) )
-            {
-               retval  = Result::list;
-               expects = no_more;
-            }
-            else if ( is_command( "quit" ) )
-            {
-               retval  = Result::quit;
-               expects = no_more;
-            }
-            else if ( is_command( "auto" ) )
-            {
-               retval  = Result::autostart;
-               expects = program_or_off;
-            }
-            else if ( is_command( "save" ) )
-            {
-               retval  = Result::save;
-               expects = program_1_to_9;
-            }
-            else if ( is_command( "run" ) )
-            {
-               retval  = Result::run;
-               expects = program;
-            }
-            else if ( is_command( "delete" ) )
-            {
-               retval  = Result::del;
-               expects = program_1_to_9;
-            }
-            else
-            {
-               err_ = "Unexpected: '";
-               err_.append( token.data(), token.size() );
-               err_ += "\'";
-               error( token );
-            }
+            err_.assign( "Too many items" );
+            distance = token_.start;
          }
       }
    }
+   else if ( is_loop )
+   {
+      // Loop - must be the last command
+      safe_insert( Command::loop );
+   }
+   else if ( token_.match == 0 )
+   {
+      unexpected( "Unexpected: '" );
+   }
+   else
+   {
+      auto *keyword = &keywords[ token_.match - 1 ];
+
+      if ( auto command = pgm_read_byte( &keyword->command ) )
+      {
+         safe_insert( static_cast<Command::command_t>( command ) );
+      }
+      else if ( not live_.empty() )
+      {
+         unexpected( "Unexpected: '" );
+      }
+      else
+      {
+         result_  = static_cast<Result>( pgm_read_byte( &keyword->result ) );
+         expects_ = pgm_read_byte( &keyword->expects );
+      }
+   }
+
+   token_.kind = Token::none;
+}
+
+/**
+ * @param c Command to insert into the program
+ */
+void Parser::safe_insert( Command::command_t c )
+{
+   if ( live_.empty() and c == Command::loop )
+   {
+      err_.assign( "Loop not allowed as first action" );
+      distance = token_.start;
+   }
+   else if ( not live_.empty() and live_.back().command == Command::loop )
+   {
+      err_.assign( "No commands allowed past *" );
+      distance = token_.start;
+   }
+   else
+   {
+      bool room = true;
+
+      // Force a 1 second delay unless given
+      if ( c != Command::delay and not live_.empty() and live_.back().ticks == 0 )
+      {
+         LOG_DEBUG( DOM, "Adding 1s delay" );
+         room = live_.add_delay( Command::to_ticks( 1000 ) );
+      }
+
+      LOG_DEBUG( DOM, "Adding item: %d", c );
+
+      // Insert a new command
+      if ( not ( room and live_.push_back( Command( c ) ) ) )
+      {
+         err_.assign( "Too many items" );
+         distance = token_.start;
+      }
+   }
+}
+
+/**
+ * @param prefix The error description
+ * @param offset Offset of the unexpected part in the token
+ */
+void Parser::unexpected( const char *prefix, uint8_t offset )
+{
+   err_ = prefix;
+
+   auto text = token_.kept();
+
+   if ( offset < text.size() )
+   {
+      err_.append( text.begin() + offset, text.end() );
+   }
+
+   err_ += "\'";
+   distance = token_.start + offset;
+}
+
+/**
+ * @return A parsing can return an program, a interactive command, nothing
+ *          or an error. The calling entity should switch case the result
+ *          to process the result.
+ *         If the result is error, the supplied error string will contain
+ *          the error text description, along with the method get_error_position
+ *          which can point to the actual location of the error in the supplied string.
+ *         If the result is a command, and the command requires a program number,
+ *          the accessor get_program_number will provide the value.
+ *         An empty (or space only) string returns 'nothing'.
+ *         Finally, a return value 'program' indicate the program is available from
+ *          the supplied program object.
+ */
+Parser::Result Parser::finish()
+{
+   // Process the last token
+   if ( err_.empty() and token_.kind != Token::none )
+   {
+      accept();
+   }
+
+   auto retval = result_;
 
    // Any errors? - Return an error
    if ( not err_.empty() )
@@ -345,10 +498,10 @@ Parser::Result Parser::parse( const etl::string_view &buffer )
       else
       {
          // If the command only has a delay - check if it is a program number
-         if ( live_.size() == 1 and live_[ 0 ].command == Command::delay )
+         if ( live_.size() == 1 and live_.back().command == Command::delay )
          {
             // Check the number
-            if ( program_number == 255 )
+            if ( program_number < 0 )
             {
                err_ = "Bad program number or delay without command";
                retval = Result::error;
@@ -362,7 +515,7 @@ Parser::Result Parser::parse( const etl::string_view &buffer )
       }
    }
    // Make sure all required args supplied
-   else if ( expects != no_more )
+   else if ( expects_ != no_more )
    {
       err_ = "Missing argument";
       retval = Result::error;
@@ -371,3 +524,15 @@ Parser::Result Parser::parse( const etl::string_view &buffer )
 
    return retval;
 }
+
+/**
+ * @param buffer The buffer to parse
+ * @return The parser result. @see finish
+ */
+Parser::Result Parser::parse( const etl::string_view &buffer )
+{
+   start();
+   feed( buffer );
+
+   return finish();
+}
@@ -0,0 +1,187 @@
+/******************************************************************************
+The MIT License(MIT)
+https://github.com/adarwoo/cyclo
+
+Copyright(c) 2021 Guillaume ARRECKX - software@arreckx.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+******************************************************************************/
+/*
+ * Packing of the program steps.
+ * See program.hpp for the layout.
+ */
+#include "program.hpp"
+
+#include <string.h>
+
+
+namespace
+{
+   constexpr uint8_t COMMAND_SHIFT = 4;
+   constexpr uint8_t MORE_IN_HEAD  = 0x08;
+   constexpr uint8_t HEAD_BITS     = 3;
+   constexpr uint8_t HEAD_MASK     = ( 1 << HEAD_BITS ) - 1;
+   constexpr uint8_t MORE          = 0x80;
+   constexpr uint8_t BITS          = 7;
+}  // namespace
+
+
+uint8_t Program::encode( const Command &cmd, uint8_t *to )
+{
+   uint32_t ticks = cmd.ticks >> HEAD_BITS;
+   uint8_t  size  = 1;
+
+   to[ 0 ] = ( cmd.command << COMMAND_SHIFT ) | ( cmd.ticks & HEAD_MASK ) | ( ticks ? MORE_IN_HEAD : 0 );
+
+   while ( ticks )
+   {
+      uint8_t byte = ticks & ~MORE;
+
+      ticks >>= BITS;
+      to[ size++ ] = byte | ( ticks ? MORE : 0 );
+   }
+
+   return size;
+}
+
+Command Program::decode( const uint8_t *at )
+{
+   Command cmd{ static_cast<Command::command_t>( *at >> COMMAND_SHIFT ), uint32_t( *at & HEAD_MASK ) };
+   bool    more  = *at & MORE_IN_HEAD;
+   uint8_t shift = HEAD_BITS;
+
+   while ( more )
+   {
+      ++at;
+      cmd.ticks |= uint32_t( *at & ~MORE ) << shift;
+      more = *at & MORE;
+      shift += BITS;
+   }
+
+   return cmd;
+}
+
+uint8_t Program::size_of( const uint8_t *at )
+{
+   uint8_t size = 1;
+
+   if ( *at & MORE_IN_HEAD )
+   {
+      while ( at[ size++ ] & MORE ) {}
+   }
+
+   return size;
+}
+
+bool Program::push_back( const Command &cmd )
+{
+   uint8_t step[ max_step_size ];
+   uint8_t size = encode( cmd, step );
+
+   if ( length + size > cyclo::program_size or steps == UINT8_MAX )
+   {
+      return false;
+   }
+
+   memcpy( code + length, step, size );
+   last = length;
+   length += size;
+   ++steps;
+
+   return true;
+}
+
+bool Program::add_delay( uint32_t ticks )
+{
+   Command cmd = back();
+   uint8_t step[ max_step_size ];
+
+   cmd.ticks += ticks;
+
+   // The last step is re-packed in place, and may grow
+   uint8_t size = encode( cmd, step );
+
+   if ( last + size > cyclo::program_size )
+   {
+      return false;
+   }
+
+   memcpy( code + last, step, size );
+   length = last + size;
+
+   return true;
+}
+
+/**
+ * The steps are checked so a corrupted copy cannot send the sequencer astray.
+ * @param from The packed steps
+ * @param size The number of bytes
+ */
+bool Program::check( const uint8_t *from, uint8_t size )
+{
+   uint8_t steps = 0;
+
+   if ( size > cyclo::program_size )
+   {
+      return false;
+   }
+
+   while ( size )
+   {
+      uint8_t command = *from >> COMMAND_SHIFT;
+      bool    more    = *from & MORE_IN_HEAD;
+      uint8_t step    = 1;
+
+      // The delay is limited to 32 bits, which bounds the size
+      while ( more and step < size and step < max_step_size )
+      {
+         more = from[ step++ ] & MORE;
+      }
+
+      if ( more or command < Command::open or command > Command::loop or steps == UINT8_MAX )
+      {
+         return false;
+      }
+
+      from += step;
+      size -= step;
+      ++steps;
+   }
+
+   return true;
+}
+
+bool Program::assign( const uint8_t *from, uint8_t size )
+{
+   clear();
+
+   if ( not check( from, size ) )
+   {
+      return false;
+   }
+
+   memcpy( code, from, size );
+
+   while ( length < size )
+   {
+      last = length;
+      length += size_of( code + length );
+      ++steps;
+   }
+
+   return true;
+}
@@ -27,6 +27,8 @@ SOFTWARE.
 #include "asx.h"
 #include "program_manager.hpp"
 
+#include <etl/algorithm.h>
+
 #include <logger.h>
 // clang-format on
 
@@ -34,32 +36,188 @@ namespace
 {
    const char *const DOM = "cyclo_man";
 
-   // Set the storage to use the maximum space, matching an EEProm page size
-   constexpr auto STORAGE_MAX_LENGTH = ( EEPROM_PAGE_SIZE * 2 ) - 5;
+   ///< Layout of the eeprom
+   constexpr uint8_t DIRECTORY_PAGE     = 0;
+   constexpr uint8_t JOURNAL_FIRST_PAGE = 1;
+   constexpr uint8_t JOURNAL_PAGES      = 4;
+   constexpr uint8_t FIRST_DATA_PAGE    = JOURNAL_FIRST_PAGE + JOURNAL_PAGES;
+   constexpr uint8_t EEPROM_PAGES       = EEPROM_SIZE / EEPROM_PAGE_SIZE;
 
-   ///< Flags for the program
-   constexpr auto ALL_ONES  = '\xff';
-   constexpr auto PGMSLOT   = 'P';
-   constexpr auto AUTOSTART = 'A';
-   constexpr auto LASTUSED  = 'L';
+   ///< Value of an erased entry
+   constexpr uint8_t ALL_ONES = 0xff;
 
-   struct PgmStorage
+   /** Entry of the allocation table. Erased (all ones) when free */
+   struct Entry
+   {
+      uint8_t first_page;
+      uint8_t page_count;
+   };
+
+   /** The allocation table */
+   struct Directory
+   {
+      Entry entry[ cyclo::max_programs ];
+   };
+
+   static_assert( sizeof( Directory ) <= EEPROM_PAGE_SIZE, "The directory must be updated in a single page write" );
+   static_assert( cyclo::program_text_size <= UINT8_MAX, "The text length is stored on a byte" );
+
+   /**
+    * Record of the settings journal. A new record is appended on each change, in the
+    *  next free slot of the journal pages, so the pages wear evenly.
+    * The most recent record has the highest sequence (in serial arithmetic).
+    */
+   struct JournalRecord
+   {
+      uint8_t seq;
+      int8_t  auto_start;
+      int8_t  last_used;
+      uint8_t check;
+
+      inline uint8_t compute_check() const { return seq ^ auto_start ^ last_used ^ 0xa5; }
+
+      ///< An erased record (all ones) is never valid
+      inline bool is_valid() const { return check == compute_check(); }
+   };
+
+   /**
+    * Heads each journal page, in place of its first record. The 8 bits check of the records
+    *  would let one random record in 256 through, so the pages left by older firmwares
+    *  (programs, or records of another layout) must be told apart as a whole.
+    */
+   struct JournalHeader
+   {
+      uint8_t magic[ 4 ];
+
+      inline bool is_valid() const { return memcmp( magic, JOURNAL_MAGIC, sizeof( magic ) ) == 0; }
+
+      inline bool is_blank() const
+      {
+         return etl::all_of( magic, magic + sizeof( magic ), []( uint8_t b ) { return b == ALL_ONES; } );
+      }
+
+      ///< 'CyJ' and the layout version
+      static constexpr uint8_t JOURNAL_MAGIC[ 4 ] = { 'C', 'y', 'J', 1 };
+   };
+
+   static_assert( sizeof( JournalHeader ) == sizeof( JournalRecord ), "The header takes the first record slot" );
+
+   constexpr uint8_t RECORDS_PER_PAGE = EEPROM_PAGE_SIZE / sizeof( JournalRecord ) - 1;
+   constexpr uint8_t JOURNAL_RECORDS  = JOURNAL_PAGES * RECORDS_PER_PAGE;
+
+   static_assert( JOURNAL_PAGES <= 8, "The pages to erase are kept in a byte" );
+
+   ///< Page of a journal record
+   constexpr uint8_t journal_page( uint8_t record ) { return JOURNAL_FIRST_PAGE + record / RECORDS_PER_PAGE; }
+
+   ///< Offset of a journal record in its page, past the header
+   constexpr uint8_t journal_offset( uint8_t record )
+   {
+      return ( 1 + record % RECORDS_PER_PAGE ) * sizeof( JournalRecord );
+   }
+
+   /**
+    * Header of a stored program. It is followed by the packed steps as held in
+    *  RAM, so loading is a copy, then by the optional source text (not 0 terminated).
+    * The CRC covers everything but itself.
+    */
+   struct Blob
    {
-      char     marker;  ///< Marker, must be a value other than 255 to be analysed
-      char     auto_start;
-      char     last_used;
-      char     pgm[ STORAGE_MAX_LENGTH ];  ///< Actual program in ASCII storage area
       uint16_t crc;
+      uint8_t  length;
+      uint8_t  text_len;
+
+      inline const uint8_t *commands() const { return reinterpret_cast<const uint8_t *>( this + 1 ); }
+      inline const char *text() const { return reinterpret_cast<const char *>( commands() + length ); }
+      inline size_t size() const { return sizeof( Blob ) + length + text_len; }
+   };
+
+   // Actual length of the blob header - excluding the CRC
+   constexpr size_t BLOB_CRC_OFFSET = sizeof( uint16_t );
+
+   ///< Compute the CRC of a stored program
+   inline uint16_t checksum( const Blob *blob )
+   {
+      return crc_io_checksum(
+         (void *)( reinterpret_cast<const uint8_t *>( blob ) + BLOB_CRC_OFFSET ), blob->size() - BLOB_CRC_OFFSET, CRC_16BIT );
+   }
+
+   ///< Number of pages required to store the given number of bytes
+   constexpr uint8_t pages_for( size_t size ) { return ( size + EEPROM_PAGE_SIZE - 1 ) / EEPROM_PAGE_SIZE; }
+
+   // Saving a program, then the settings, queues its pages, the directory, and a journal erase and write
+   static_assert(
+      cyclo::nvm_queue_length >= pages_for( sizeof( Blob ) + cyclo::program_size + cyclo::program_text_size ) + 3,
+      "The eeprom writer queue must hold a whole program save, so the callers never block" );
+
+   /**
+    * Buffers the data written in a page sized job, and posts the
+    *  job to the eeprom writer each time it fills up.
+    */
+   class PageWriter
+   {
+      NvmWriter     &nvm;
+      NvmWriter::Job job;
+      uint8_t        pos;
+
+   public:
+      PageWriter( NvmWriter &nvm, uint8_t first_page ) : nvm{ nvm }, pos{ 0 }
+      {
+         job.op     = NvmWriter::write_page;
+         job.page   = first_page;
+         job.notify = false;
+      }
+
+      void write( const void *data, size_t size )
+      {
+         auto *bytes = static_cast<const uint8_t *>( data );
+
+         while ( size-- )
+         {
+            job.data[ pos++ ] = *bytes++;
+
+            if ( pos == EEPROM_PAGE_SIZE )
+            {
+               flush();
+            }
+         }
+      }
+
+      ///< Write the partial page, filled with all ones. Optionally notify once written
+      void flush( bool notify = false )
+      {
+         if ( pos )
+         {
+            memset( job.data + pos, ALL_ONES, EEPROM_PAGE_SIZE - pos );
+            job.notify = notify;
+            nvm.post( job );
+            ++job.page;
+            pos = 0;
+         }
+      }
    };
 
-   // Actual length of the data - excluding the CRC
-   constexpr size_t PGM_STORAGE_DATA_SIZE_NO_CRC = sizeof( PgmStorage ) - sizeof( uint16_t );
+   ///< Check an entry points into the data pages
+   inline bool is_valid( const Entry &e )
+   {
+      return e.page_count > 0 and e.first_page >= FIRST_DATA_PAGE
+         and e.first_page + e.page_count <= EEPROM_PAGES;
+   }
 
-   // Zero string
-   etl::string<0> zs;
+   ///< Check if 2 entries share some pages
+   inline bool overlaps( const ProgramManager::Slot &a, const ProgramManager::Slot &b )
+   {
+      return a.first_page < b.first_page + b.page_count and b.first_page < a.first_page + a.page_count;
+   }
 
-   // Default manual program string
-   const char *DEFAULT_MANUAL_PGM = "c 1M 0s o 0M 5s *";
+   ///< Fill in the default manual program - 'c 1M 0s o 0M 5s *'
+   void make_default( Program &pgm )
+   {
+      pgm.clear();
+      pgm.push_back( Command{ Command::close, Command::to_ticks( 60000 ) } );
+      pgm.push_back( Command{ Command::open, Command::to_ticks( 5000 ) } );
+      pgm.push_back( Command{ Command::loop } );
+   }
 };  // namespace
 
 ProgramManager::ProgramManager()
@@ -68,7 +226,10 @@ ProgramManager::ProgramManager()
    , last_used{ -1 }
    , state{ stopped }
    , counter{ -1 }
-   , parser{ active_program, zs }
+   , journal_next{ 0 }
+   , journal_seq{ 0 }
+   , published{ 0 }
+   , acquired{ 0 }
 {
    LOG_HEADER( DOM );
 
@@ -87,48 +248,85 @@ ProgramManager::ProgramManager()
    // The program 0 must exists - create on if nothing
    if ( not occupancy_map[ 0 ] )
    {
-      write_pgm_at( 0, DEFAULT_MANUAL_PGM );
+      Program &pgm = claim();
+
+      make_default( pgm );
+      write_pgm_at( 0, pgm );
    }
 }
 
-void ProgramManager::scan()
+/**
+ * Rebuild the RAM directory and the settings from the eeprom.
+ * Every program is checked against its CRC, so this is slow. It is only
+ *  required at boot, or to check the eeprom on request.
+ */
+uint8_t ProgramManager::scan()
 {
    LOG_HEADER( DOM );
 
-   nvm_wait_until_ready();
-   eeprom_enable_mapping();
+   uint8_t dropped = 0;
+   uint8_t foreign;
+
+   // The directory is rebuilt from scratch
+   rtos::Lock_guard guard{ lock };
 
-   // Read the pages, looking for entries
-   for ( uint8_t i = 0; i < 10; ++i )
    {
-      // Address of the block
-      PgmStorage *pgm = pgm_mapped_at<PgmStorage>( i );
+      NvmWriter::Reader reader( nvm );
+
+      occupancy_map.reset();
+      auto_start = -1;
+      last_used  = -1;
 
-      if ( pgm->marker == PGMSLOT )
+      foreign = read_journal();
+
+      // Walk the allocation table, dropping invalid or overlapping entries
+      auto *dir = mapped_at<Directory>( DIRECTORY_PAGE );
+
+      for ( uint8_t i = 0; i < cyclo::max_programs; ++i )
       {
-         // Compute the crc for the slot. Add one for the marker
-         uint16_t crc = crc_io_checksum( pgm, PGM_STORAGE_DATA_SIZE_NO_CRC, CRC_16BIT );
+         const Entry &e = dir->entry[ i ];
 
-         if ( crc == pgm->crc )
+         if ( not is_valid( e ) )
          {
-            occupancy_map.set( i );
+            continue;
+         }
 
-            // Is it the auto start?
-            if ( pgm->auto_start == AUTOSTART )
-            {
-               // Indicate the program is auto_start
-               auto_start = i;
-            }
+         auto *blob = mapped_at<Blob>( e.first_page );
+         Slot &slot = directory[ i ];
 
-            // Is is the default (for the GUI)
-            if ( pgm->last_used == LASTUSED )
-            {
-               // Indicate the program is auto_start
-               last_used = i;
-            }
+         slot = Slot{ e.first_page, e.page_count, blob->length, blob->text_len, blob->crc };
+
+         bool clash = false;
+
+         for ( uint8_t j = 0; j < i; ++j )
+         {
+            clash |= occupancy_map[ j ] and overlaps( slot, directory[ j ] );
+         }
+
+         if ( clash or pages_for( blob->size() ) > e.page_count )
+         {
+            LOG_WARN( DOM, "Dropping bad entry %d", i );
+            ++dropped;
+         }
+         else if ( checksum( blob ) != blob->crc or not Program::check( blob->commands(), blob->length ) )
+         {
+            LOG_WARN( DOM, "Bad CRC or steps for entry %d", i );
+            ++dropped;
+         }
+         else
+         {
+            occupancy_map.set( i );
          }
       }
    }
+
+   // Make room for the new journal, once the writer is free again
+   if ( foreign )
+   {
+      erase_journal( foreign );
+   }
+
+   return dropped;
 }
 
 /**
@@ -174,114 +372,277 @@ int8_t ProgramManager::get_prev( int8_t from )
 }
 
 /**
+ * The text is copied out, as the eeprom may be rewritten as soon as released.
  * @param index Index of the program to look for
- * @return a pointer to the program at the given index
+ * @param text Receives the source text, truncated to its capacity
+ * @return false if no text was stored
  */
-const char *ProgramManager::get_pgm( uint8_t index )
+bool ProgramManager::get_text( uint8_t index, etl::istring &text )
 {
    LOG_HEADER( DOM );
 
-   nvm_wait_until_ready();
-   eeprom_enable_mapping();
+   text.clear();
+
+   if ( not occupancy_map[ index ] )
+   {
+      return false;
+   }
+
+   const Slot &slot = directory[ index ];
+
+   if ( slot.text_len == 0 )
+   {
+      return false;
+   }
+
+   NvmWriter::Reader reader( nvm );
+
+   auto *blob = mapped_at<Blob>( slot.first_page );
+
+   text.assign( blob->text(), etl::min<size_t>( slot.text_len, text.capacity() ) );
 
-   auto *pgm = pgm_mapped_at<PgmStorage>( index );
+   return true;
+}
+
+/**
+ * Copy a stored program. The content is checked against its CRC.
+ * @param index Index of the program to read
+ * @param pgm The program to overwrite
+ * @return true if the program is valid
+ */
+bool ProgramManager::read( uint8_t index, Program &pgm )
+{
+   LOG_HEADER( DOM );
+
+   if ( not occupancy_map[ index ] )
+   {
+      return false;
+   }
+
+   const Slot &slot = directory[ index ];
+
+   NvmWriter::Reader reader( nvm );
+
+   auto *blob = mapped_at<Blob>( slot.first_page );
+
+   if ( blob->length != slot.length or checksum( blob ) != slot.crc or not pgm.assign( blob->commands(), blob->length ) )
+   {
+      LOG_ERROR( DOM, "Program %d is corrupted", index );
+      return false;
+   }
+
+   return true;
+}
+
+/**
+ * Find a free run of pages, first fit.
+ * @param page_count Number of pages to allocate
+ * @param reusable Index of a program whose pages can be reused, or -1
+ * @return The first page allocated or -1 if there is no room
+ * The caller must hold the lock until the pages are entered in the directory.
+ */
+int8_t ProgramManager::allocate( uint8_t page_count, int8_t reusable )
+{
+   Slot candidate = { FIRST_DATA_PAGE, page_count };
+
+   while ( candidate.first_page + page_count <= EEPROM_PAGES )
+   {
+      bool clash = false;
+
+      for ( uint8_t i = 0; i < cyclo::max_programs and not clash; ++i )
+      {
+         if ( occupancy_map[ i ] and i != reusable and overlaps( candidate, directory[ i ] ) )
+         {
+            // Skip past this entry
+            candidate.first_page = directory[ i ].first_page + directory[ i ].page_count;
+            clash                = true;
+         }
+      }
+
+      if ( not clash )
+      {
+         return candidate.first_page;
+      }
+   }
 
-   // Skip the marker
-   return pgm->pgm;
+   return -1;
 }
 
 /**
  * @param pos Index of the program
- * @stirng The content to write. The CRC is automatically added
- * @return a pointer to the program at the given index
+ * @param pgm The compiled program to store
+ * @param text Optional source text, stored alongside
+ * @return true if the program was stored, false if the eeprom is full
  */
-void ProgramManager::write_pgm_at( uint8_t pos, etl::string_view view )
+bool ProgramManager::write_pgm_at( uint8_t pos, const Program &pgm, etl::string_view text )
 {
    LOG_HEADER( DOM );
 
-   PgmStorage buffer;
+   Blob header;
+
+   header.length   = pgm.bytes();
+   header.text_len = etl::min<size_t>( text.size(), cyclo::program_text_size );
+
+   uint8_t page_count = pages_for( header.size() );
 
-   // Reset the buffer content to all zero
-   memset( &buffer, 0, sizeof( buffer ) );
+   // The UI and the console both save. Hold the directory from the allocation to its update
+   rtos::Lock_guard guard{ lock };
 
-   // Determine the mode from the current settings
-   buffer.marker     = PGMSLOT;
-   buffer.auto_start = ( auto_start == pos ) ? AUTOSTART : ALL_ONES;
-   buffer.last_used  = ( last_used == pos ) ? LASTUSED : ALL_ONES;
+   // Keep the current copy intact until the new one is written. Overwrite it if no choice.
+   int8_t first_page = allocate( page_count, -1 );
+
+   if ( first_page < 0 )
+   {
+      first_page = allocate( page_count, pos );
+   }
+
+   if ( first_page < 0 )
+   {
+      LOG_ERROR( DOM, "No room for %d pages", page_count );
+      return false;
+   }
 
-   strncpy( buffer.pgm, view.data(), etl::min( view.size(), STORAGE_MAX_LENGTH ) );
+   // Compute CRC - everything but the crc itself
+   crc_io_checksum_byte_start( CRC_16BIT );
 
-   // Compute CRC - the whole buffer excluding the crc itself
-   buffer.crc = crc_io_checksum( &buffer, PGM_STORAGE_DATA_SIZE_NO_CRC, CRC_16BIT );
+   for ( auto *p = &header.length; p != reinterpret_cast<uint8_t *>( &header + 1 ); ++p )
+   {
+      crc_io_checksum_byte_add( *p );
+   }
+
+   for ( auto *p = pgm.data(); p != pgm.data() + pgm.bytes(); ++p )
+   {
+      crc_io_checksum_byte_add( *p );
+   }
+
+   for ( uint8_t i = 0; i < header.text_len; ++i )
+   {
+      crc_io_checksum_byte_add( text[ i ] );
+   }
 
-   // Write eeprom
-   nvm_eeprom_load_page_to_buffer( reinterpret_cast<const uint8_t *>( &buffer ) );
-   nvm_eeprom_atomic_write_page( pos * 2 );
-   nvm_eeprom_load_page_to_buffer(
-      reinterpret_cast<const uint8_t *>( &buffer ) + EEPROM_PAGE_SIZE );
-   nvm_eeprom_atomic_write_page( ( pos * 2 ) + 1 );
+   header.crc = crc_io_checksum_byte_stop();
 
-   // Mark as available
+   // Write the program in the background
+   PageWriter writer( nvm, first_page );
+
+   writer.write( &header, sizeof( header ) );
+   writer.write( pgm.data(), pgm.bytes() );
+   writer.write( text.data(), header.text_len );
+   writer.flush();
+
+   // Commit by updating the allocation table
+   directory[ pos ] = Slot{ (uint8_t)first_page, page_count, header.length, header.text_len, header.crc };
    occupancy_map.set( pos );
+
+   write_directory();
+
+   return true;
+}
+
+/**
+ * The table is rebuilt from the RAM copy, so no read of the eeprom is required.
+ * The job is queued after any pending program write, so the entry never
+ *  points to an incomplete program.
+ */
+void ProgramManager::write_directory()
+{
+   Directory dir;
+
+   for ( uint8_t i = 0; i < cyclo::max_programs; ++i )
+   {
+      if ( occupancy_map[ i ] )
+      {
+         dir.entry[ i ] = Entry{ directory[ i ].first_page, directory[ i ].page_count };
+      }
+      else
+      {
+         dir.entry[ i ] = Entry{ ALL_ONES, ALL_ONES };
+      }
+   }
+
+   PageWriter writer( nvm, DIRECTORY_PAGE );
+   writer.write( &dir, sizeof( dir ) );
+   writer.flush( true );
 }
 
 /**
- * The program is loaded, parsed. If OK, the get_program() method gives access
+ * The program is copied from the eeprom. If OK, the get_program() method gives access
  * to the command.
  * Errors are ignored, but logged.
- * If OK, start the sequencer
  * @param index Index of the program to load
- * @return true if all ok
  */
 void ProgramManager::load( uint8_t pgmIndex )
 {
    LOG_HEADER( DOM );
-   bool loaded = false;
 
    // As different tasks using this method, make it safe
-   rtos::Lock_guard{ lock };
+   rtos::Lock_guard guard{ lock };
 
-   // Must have a program
-   if ( occupancy_map[ pgmIndex ] )
-   {
-      // Get the string
-      etl::string_view pgm{ get_pgm( pgmIndex ) };
-
-      // Parse
-      auto res = parser.parse( pgm );
-      loaded   = ( res == Parser::Result::program );
-   }
+   Program &pgm = claim();
 
    // Force a default to avoid the system going ape
-   if ( not loaded )
+   if ( not read( pgmIndex, pgm ) )
    {
-      active_program.clear();
-
-      // Insert items
-      active_program.push_back( Command{ Command::open, 60000 } );
-      active_program.push_back( Command{ Command::close, 5000 } );
-      active_program.push_back( Command{ Command::loop } );
+      make_default( pgm );
    }
+
+   publish( pgm );
 }
 
 /**
  * Load a program into the active program and start
  * The given program is copied.
  * @param The program to load.
+ * @param start If false, the program is only loaded
  */
-void ProgramManager::load( const Program &pgm )
+void ProgramManager::load( const Program &pgm, bool start )
 {
    LOG_HEADER( DOM );
 
    // As different tasks using this method, make it safe
-   rtos::Lock_guard{ lock };
+   rtos::Lock_guard guard{ lock };
 
    // Make a copy
-   active_program.assign( pgm.begin(), pgm.end() );
-   active_program.start();
+   Program &copy = claim();
+
+   copy = pgm;
+   copy.start();
+   publish( copy );
 
    // Let the sequencer know
-   fx::publish( msg::StartProgram{ true } );
+   if ( start )
+   {
+      fx::publish( msg::StartProgram{ true } );
+   }
+}
+
+/**
+ * The indexes are swapped with the interrupts masked for a few cycles, so the
+ *  sequencer never waits for a loader.
+ * A newly published program replaces the current one, from its first step.
+ */
+Program &ProgramManager::acquire()
+{
+   taskENTER_CRITICAL();
+   acquired = published;
+   taskEXIT_CRITICAL();
+
+   return programs[ acquired ];
+}
+
+/**
+ * A program published but not yet acquired is withdrawn, since its buffer
+ *  is the one to fill. The sequencer keeps the current program meanwhile.
+ * The caller must hold the lock.
+ */
+Program &ProgramManager::claim()
+{
+   taskENTER_CRITICAL();
+   published     = acquired;
+   uint8_t spare = acquired ^ 1;
+   taskEXIT_CRITICAL();
+
+   return programs[ spare ];
 }
 
 void ProgramManager::stop()
@@ -298,51 +659,183 @@ void ProgramManager::resume()
 
 void ProgramManager::erase( uint8_t pgmIndex )
 {
-   nvm_eeprom_erase_page( pgmIndex * 2 );
+   rtos::Lock_guard guard{ lock };
+
+   // Free the entry. The pages are simply reused later
    occupancy_map.set( pgmIndex, false );
+
+   write_directory();
 }
 
-void ProgramManager::set_autostart( int8_t pgmIndex )
+/**
+ * Find the most recent record of the settings journal.
+ * A record interrupted by a power loss fails its check, so the previous
+ *  record is used instead. The pages without the format magic are skipped.
+ */
+uint8_t ProgramManager::read_journal()
 {
-   auto prev = auto_start;
+   const JournalRecord *newest  = nullptr;
+   uint8_t              foreign = 0;
 
-   // Make this program the new auto-start
-   auto_start = pgmIndex;
+   journal_next = 0;
+   journal_seq  = 0;
 
-   if ( prev != auto_start )
+   for ( uint8_t page = 0; page < JOURNAL_PAGES; ++page )
    {
-      // Could be -1 to simply turn off auto-start
-      if ( pgmIndex >= 0 )
+      auto *header = mapped_at<JournalHeader>( JOURNAL_FIRST_PAGE + page );
+
+      if ( not header->is_valid() )
       {
-         write_pgm_at( pgmIndex, get_pgm( pgmIndex ) );
+         // Left by an older firmware, or a power loss during the format
+         if ( not header->is_blank()
+              or etl::any_of(
+                 reinterpret_cast<const uint8_t *>( header + 1 ),
+                 reinterpret_cast<const uint8_t *>( header ) + EEPROM_PAGE_SIZE,
+                 []( uint8_t b ) { return b != ALL_ONES; } ) )
+         {
+            LOG_WARN( DOM, "Foreign journal page %d", page );
+            foreign |= 1 << page;
+         }
+
+         continue;
       }
 
-      // Re-write the previous program to remove its attribute
-      if ( prev >= 0 )
+      auto *records = reinterpret_cast<const JournalRecord *>( header + 1 );
+
+      for ( uint8_t i = 0; i < RECORDS_PER_PAGE; ++i )
       {
-         write_pgm_at( prev, get_pgm( prev ) );
+         if ( records[ i ].is_valid() and ( newest == nullptr or (int8_t)( records[ i ].seq - newest->seq ) > 0 ) )
+         {
+            newest       = &records[ i ];
+            journal_next = ( page * RECORDS_PER_PAGE + i + 1 ) % JOURNAL_RECORDS;
+         }
       }
    }
+
+   if ( newest == nullptr )
+   {
+      return foreign;
+   }
+
+   journal_seq = newest->seq + 1;
+
+   if ( newest->auto_start < (int8_t)cyclo::max_programs )
+   {
+      auto_start = newest->auto_start;
+   }
+
+   if ( newest->last_used < (int8_t)cyclo::max_programs )
+   {
+      last_used = newest->last_used;
+   }
+
+   return foreign;
+}
+
+/**
+ * The pages are formatted again by the next record written to them.
+ */
+void ProgramManager::erase_journal( uint8_t pages )
+{
+   NvmWriter::Job job;
+
+   job.op     = NvmWriter::erase_page;
+   job.notify = false;
+
+   for ( uint8_t page = 0; page < JOURNAL_PAGES; ++page )
+   {
+      if ( pages & ( 1 << page ) )
+      {
+         job.page = JOURNAL_FIRST_PAGE + page;
+         nvm.post( job );
+      }
+   }
+}
+
+/**
+ * Append the settings to the journal with a split write of the record only.
+ * The page is erased first if the slot is not blank, which happens when the
+ *  journal wraps onto its oldest page. A page without its header gets it
+ *  written along with the record.
+ */
+void ProgramManager::write_settings()
+{
+   JournalRecord record = { journal_seq, auto_start, last_used, 0 };
+   record.check         = record.compute_check();
+
+   uint8_t page   = journal_page( journal_next );
+   uint8_t offset = journal_offset( journal_next );
+
+   bool blank, formatted;
+
+   // Released before posting, so the writer is not held off by a full queue
+   {
+      NvmWriter::Reader reader( nvm );
+
+      auto *slot = mapped_at<uint8_t>( page ) + offset;
+
+      blank     = etl::all_of( slot, slot + sizeof( record ), []( uint8_t b ) { return b == ALL_ONES; } );
+      formatted = mapped_at<JournalHeader>( page )->is_valid();
+   }
+
+   NvmWriter::Job job;
+
+   job.page   = page;
+   job.notify = false;
+
+   // Reused on the next pass over the journal, or not formatted - start the page afresh
+   bool const erase = not blank or not formatted;
+
+   if ( erase )
+   {
+      job.op = NvmWriter::erase_page;
+      nvm.post( job );
+   }
+
+   job.op     = NvmWriter::split_write;
+   job.offset = offset;
+   job.length = sizeof( record );
+   job.notify = true;
+   memcpy( job.data, &record, sizeof( record ) );
+
+   // Write the header too, as the erase cleared it - the bytes in between are left erased
+   if ( erase )
+   {
+      memset( job.data, ALL_ONES, offset );
+      memcpy( job.data, JournalHeader::JOURNAL_MAGIC, sizeof( JournalHeader ) );
+      memcpy( job.data + offset, &record, sizeof( record ) );
+      job.offset = 0;
+      job.length = offset + sizeof( record );
+   }
+
+   nvm.post( job );
+
+   journal_next = ( journal_next + 1 ) % JOURNAL_RECORDS;
+   ++journal_seq;
+}
+
+void ProgramManager::set_autostart( int8_t pgmIndex )
+{
+   auto prev = auto_start;
+
+   // Make this program the new auto-start. Could be -1 to simply turn off auto-start
+   auto_start = pgmIndex;
+
+   if ( prev != auto_start )
+   {
+      write_settings();
+   }
 }
 
 void ProgramManager::set_lastused( int8_t pgmIndex )
 {
    auto prev = last_used;
 
-   // Make this program the new auto-start
+   // Make this program the new last used
    last_used = pgmIndex;
 
    if ( prev != last_used )
    {
-      if ( pgmIndex >= 0 )
-      {
-         write_pgm_at( pgmIndex, get_pgm( pgmIndex ) );
-      }
-
-      // Re-write the previous program to remove its attribute
-      if ( prev >= 0 )
-      {
-         write_pgm_at( prev, get_pgm( prev ) );
-      }
+      write_settings();
    }
 }
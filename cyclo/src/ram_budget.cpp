@@ -0,0 +1,111 @@
+/******************************************************************************
+The MIT License(MIT)
+https://github.com/adarwoo/cyclo
+
+Copyright(c) 2021 Guillaume ARRECKX - software@arreckx.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+******************************************************************************/
+
+/*
+ * ram_budget.cpp
+ *
+ * The allocations are listed once, and expanded both to add up the total and
+ *  to report them. The sizes are those of the objects, so the control blocks,
+ *  queues and members come with the stacks and buffers set in conf_ram.hpp.
+ * The objects of main() live on the startup stack, which is never given back.
+ * Each size is also exported as an absolute symbol 'ram_budget.<name>', which
+ *  costs no memory, so the build prints the table after linking (see rules.mak).
+ */
+#include "ram_budget.hpp"
+
+#include "asx.h"
+#include "conf_ram.hpp"
+#include "console.hpp"
+#include "edge_log.hpp"
+#include "keypad_tasklet.hpp"
+#include "msg_defs.hpp"
+#include "nonc_tasklet.hpp"
+#include "program_manager.hpp"
+#include "sequencer_worker.hpp"
+#include "ui_worker.hpp"
+
+#include <hw_timer.hpp>
+
+
+namespace
+{
+   ///< @return The size of a static task with the given stack depth
+   constexpr size_t task_size( size_t depth ) { return sizeof( StaticTask_t ) + depth * sizeof( StackType_t ); }
+
+   ///< Largest command of the timer daemon queue - a pended function call. The type is private to timers.c
+   constexpr size_t timer_command_size = sizeof( BaseType_t ) + 2 * sizeof( void * ) + sizeof( uint32_t );
+
+// All the static allocations, as X( name, bytes )
+#define RAM_ALLOCATIONS( X )                                                                  \
+   X( sq_bus, sizeof( msg::sequencer_bus_t ) )                                                \
+   X( ui_bus, sizeof( msg::ui_bus_t ) )                                                       \
+   X( console, sizeof( Console ) )                                                            \
+   X( ui, sizeof( UIWorker ) )                                                                \
+   X( sequencer, sizeof( SequencerWorker ) )                                                  \
+   X( programs, sizeof( ProgramManager ) )                                                    \
+   X( tasklets, sizeof( KeypadTasklet ) + sizeof( NoNcTasklet ) )                             \
+   X( idle, task_size( configMINIMAL_STACK_SIZE ) )                                           \
+   X( timers,                                                                                 \
+      task_size( configTIMER_TASK_STACK_DEPTH ) + sizeof( StaticQueue_t )                     \
+         + configTIMER_QUEUE_LENGTH * timer_command_size )                                    \
+   X( fx_timed, fx::timed::slots * fx::timed::slot_size )                                     \
+   X( edge_log, cyclo::edge_log_size * sizeof( edge_log::Record ) )                           \
+   X( display, GFX_MONO_LCD_FRAMEBUFFER_SIZE )
+
+#define RAM_ADD( name, bytes ) +( bytes )
+
+   constexpr size_t total = 0 RAM_ALLOCATIONS( RAM_ADD );
+
+#ifndef _POSIX
+   // The host sizes are larger (pointers, stack words) - only the target is checked
+   static_assert( total <= cyclo::ram_budget, "The static allocations exceed the RAM budget (see conf_ram.hpp)" );
+#endif
+
+#define RAM_EXPORT( name, bytes ) \
+   asm( ".global ram_budget." #name "\n\t.equ ram_budget." #name ", %c0" ::"i"( bytes ) );
+
+   /**
+    * Never called. Only emitted (once, as it is never inlined nor cloned) for the
+    *  symbols its assembly defines
+    */
+   __attribute__( ( used, noinline ) ) void export_sizes()
+   {
+      RAM_ALLOCATIONS( RAM_EXPORT )
+      RAM_EXPORT( total, total )
+      RAM_EXPORT( budget, cyclo::ram_budget )
+   }
+}  // namespace
+
+
+namespace ram_budget
+{
+   void report( report_t report )
+   {
+#define RAM_REPORT( name, bytes ) report( PSTR( #name ), bytes );
+
+      RAM_ALLOCATIONS( RAM_REPORT )
+
+      report( PSTR( "total" ), total );
+      report( PSTR( "budget" ), cyclo::ram_budget );
+   }
+}  // namespace ram_budget
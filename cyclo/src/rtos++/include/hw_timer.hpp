@@ -0,0 +1,160 @@
+/******************************************************************************
+The MIT License(MIT)
+https://github.com/adarwoo/cyclo
+
+Copyright(c) 2021 Guillaume ARRECKX - software@arreckx.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+******************************************************************************/
+#ifndef hw_timer_hpp_included
+#define hw_timer_hpp_included
+/**
+ * @file
+ * Software timers multiplexed on a single hardware timer (HWTIMER_TC).
+ *
+ * Unlike the rtos::Timer, the timers do not go through the timer daemon
+ *  command queue, and have a resolution of a microsecond.
+ * The active timers are kept in a list sorted by expiry, and the compare channel
+ *  of the hardware timer is set to the first expiry.
+ * A timer can be started and stopped from a task or from an ISR. Stopping is O(1),
+ *  starting walks the active timers to insert it in order.
+ * The callback is called either straight from the timer interrupt, or deferred
+ *  to the timer daemon task. The interrupt does not switch context itself, so a
+ *  deferred callback runs at the latest on the next tick.
+ * The expired deferred timers are linked in a ready list, which a single call
+ *  pended to the timer daemon drains. Should the daemon queue be full, the call
+ *  is pended again from the next compare, so no expiry is lost.
+ * A deferred callback is never called once its timer was stopped or restarted,
+ *  even if the daemon call is already queued.
+ */
+#include <rtos.hpp>
+
+
+namespace rtos
+{
+   class HwTimer
+   {
+   public:
+      ///< Context of the callback
+      enum class context_t : uint8_t { isr, deferred };
+
+      using callback_t = etl::delegate<void()>;
+
+   private:
+      ///< Neighbours in the list of active timers
+      HwTimer *prev, *next;
+
+      ///< Time of the expiry in timer counts
+      uint32_t expiry;
+
+      ///< Period in timer counts, or 0 for a one-shot
+      uint32_t period;
+
+      ///< Function to call
+      callback_t callback;
+
+      ///< Where the callback is called from
+      context_t context;
+
+      ///< Next timer in the ready list
+      HwTimer *next_ready;
+
+      ///< True while in the ready list
+      bool ready;
+
+      ///< Active timers, soonest first
+      static HwTimer *head;
+
+      ///< Expired deferred timers, to call from the timer daemon, oldest first
+      static HwTimer *ready_head, *ready_tail;
+
+      ///< True while a call to drain the ready list is queued to the timer daemon
+      static bool drain_queued;
+
+      ///< Timer whose deferred callback is being called
+      static HwTimer *volatile running;
+
+   public:
+      explicit HwTimer( callback_t callback, context_t context = context_t::deferred );
+
+      ~HwTimer();
+
+      ///< Start or restart the timer. The delay is in microseconds
+      void start( uint32_t delay_us, bool periodic = false );
+
+      ///< Start or restart the timer from an ISR
+      void start_from_isr( uint32_t delay_us, bool periodic = false );
+
+      ///< Stop the timer
+      void stop();
+
+      ///< Stop the timer from an ISR
+      void stop_from_isr();
+
+      ///< @return true if the timer is running
+      bool is_active() const { return prev != nullptr or head == this; }
+
+      ///< @return The time left before the next expiry in microseconds, or 0 if stopped
+      uint32_t remaining_us() const;
+
+   protected:
+      ///< Link the timer in the list. Interrupts must be masked
+      void schedule( uint32_t delay_us, bool periodic );
+
+      ///< Insert the timer in the list by expiry. Interrupts must be masked
+      void link();
+
+      ///< Unlink the timer from the list if active. Interrupts must be masked
+      void cancel();
+
+      ///< Remove the timer from the ready list. Interrupts must be masked
+      void unready();
+
+      ///< Call the callback, or add the timer to the ready list. Interrupts must be masked
+      void fire();
+
+      ///< Start the hardware timer, on the first construction
+      static void init();
+
+      ///< @return The current time in timer counts. Interrupts must be masked
+      static uint32_t now();
+
+      ///< Set the hardware compare to the first expiry. Interrupts must be masked
+      static void arm();
+
+      ///< Call the expired timers. Called from the compare interrupt
+      static void expire();
+
+      ///< Pend the draining of the ready list to the timer daemon, if not queued already
+      ///< @return false if the daemon queue is full, and the call must be retried
+      static bool defer();
+
+      ///< Call the deferred callbacks of the ready list. Run by the timer daemon
+      static void drain( void *, uint32_t );
+
+      ///< Wake the service up after a change. Interrupts must not be masked
+      static void kick();
+      static void kick_from_isr();
+
+#ifdef _POSIX
+      ///< Simulated timer interrupt
+      static void service();
+#endif
+   };
+}  // namespace rtos
+
+#endif  // ndef hw_timer_hpp_included
@@ -192,6 +192,65 @@ namespace rtos
    };
 #endif
 
+   ///< Index of the task notification used by Signal and EventFlags. Index 0 is left to the drivers
+   constexpr UBaseType_t notification_index = 1;
+
+   /**
+    *  Lightweight binary signal, given by any task or ISR, and waited for by a single task.
+    *  It uses the notification of the waiting task, rather than a semaphore control block.
+    *  The waiting task is the last one which called wait(). Signals given before any task
+    *  waited are kept, and delivered on the first wait.
+    */
+   class Signal
+   {
+      ///< Task waiting for the signal
+      TaskHandle_t volatile waiter;
+      ///< Given before any task waited
+      volatile bool pending;
+
+   public:
+      constexpr Signal() : waiter{ nullptr }, pending{ false } {}
+
+      /** Give the signal */
+      void give();
+
+      /** Give the signal from ISR context */
+      void give_from_isr( BaseType_t *pxHigherPriorityTaskWoken );
+
+      /**
+       *  Wait for the signal, and consume it.
+       *  @return true if the signal was given, false if it timed out.
+       */
+      bool wait( tick_t timeout = tick::infinite );
+   };
+
+   /**
+    *  Lightweight set of 32 event flags, set by any task or ISR, and waited for by a single task.
+    *  Like the Signal, it uses the notification value of the waiting task.
+    */
+   class EventFlags
+   {
+      ///< Task waiting for the flags
+      TaskHandle_t volatile waiter;
+      ///< Flags set before any task waited
+      volatile uint32_t pending;
+
+   public:
+      constexpr EventFlags() : waiter{ nullptr }, pending{ 0 } {}
+
+      /** Set some flags */
+      void set( uint32_t flags );
+
+      /** Set some flags from ISR context */
+      void set_from_isr( uint32_t flags, BaseType_t *pxHigherPriorityTaskWoken );
+
+      /**
+       *  Wait for any flag to be set. All the flags are cleared on return.
+       *  @return The flags set, or 0 if it timed out.
+       */
+      uint32_t wait( tick_t timeout = tick::infinite );
+   };
+
    /**
     *  A FreeRTOS wrapper for its concept of a Pended Function.
     *  In Linux, one permutation of this would be a Tasklet, or
@@ -248,15 +307,90 @@ namespace rtos
        */
       static void TaskletAdapterFunction( void *ref, uint32_t parameter );
 
+      /**
+       *  Account for a call which has run, or failed to be scheduled.
+       */
+      void done();
+
+      /**
+       *  Same as done(), for a call which failed to be scheduled from an ISR.
+       */
+      void done_from_isr( BaseType_t *pxHigherPriorityTaskWoken );
+
+      /**
+       *  Number of calls scheduled and not run yet.
+       */
+      volatile uint8_t pending;
+
       /**
        *  Protect against accidental deletion before we were executed.
        */
-      SemaphoreHandle_t DtorLock;
+      Signal idle;
+   };
 
-   protected:
-      StaticSemaphore_t xSemaphoreBuffer;
+
+   ///< Stack usage of a task, in bytes
+   struct StackUsage
+   {
+      const char *name;    ///< Name of the task
+      size_t      size;    ///< Size of the stack
+      size_t      unused;  ///< Part of the stack never used so far (high-water mark)
    };
 
+   ///< Statistics of a task since the previous report
+   struct TaskStats : StackUsage
+   {
+      uint32_t run_time;  ///< Time run, in run time counter units (microseconds)
+      uint16_t switches;  ///< Number of times the task was switched in
+      uint16_t load;      ///< Share of the CPU in 1/1000
+   };
+
+   /**
+    * Registry of the tasks, to report on their stack usage and run time.
+    * All the rtos::Task instances register themselves on construction, and the
+    *  idle and timer tasks of the kernel are added to the report.
+    * The kernel paints the stacks on creation (configCHECK_FOR_STACK_OVERFLOW > 1), so the
+    *  unused part is the painted area left intact.
+    * The run time statistics are reported since the previous report, with the time spent in
+    *  the probed interrupts as an extra 'ISR' entry (see timebase.hpp).
+    */
+   class TaskRegistry
+   {
+   public:
+      ///< Counters of a task at the previous report
+      struct Marks
+      {
+         uint32_t run_time;
+         uint16_t switches;
+      };
+
+   private:
+      ///< Most recently registered task
+      static TaskRegistry *first;
+      ///< Next task in the registry
+      TaskRegistry *next;
+      ///< Counters at the previous report
+      Marks marks;
+
+   protected:
+      ///< Handle to the task
+      TaskHandle_t handle;
+      ///< Size of the stack in words
+      const size_t stack_depth;
+
+      explicit TaskRegistry( size_t depth );
+
+   public:
+      using report_t = etl::delegate<void( const StackUsage & )>;
+
+      ///< Pass the stack usage of each task to the report function
+      static void report_stack_usage( report_t report );
+
+      using stats_report_t = etl::delegate<void( const TaskStats & )>;
+
+      ///< Pass the statistics of each task since the previous call to the report function
+      static void report_task_stats( stats_report_t report );
+   };
 
    /**
     * Create a new static task.
@@ -272,12 +406,10 @@ namespace rtos
       class TName,
       const size_t     TStackSize = 0,
       const priority_t TPriority  = rtos::priority_t::normal>
-   class Task
+   class Task : public TaskRegistry
    {
       using delegator_t = etl::delegate<void()>;
 
-      ///< Handle to the task
-      TaskHandle_t handle;
       ///< The stack size is on top of freeRTOS minimum requirement
       static constexpr auto stack_size = configMINIMAL_STACK_SIZE + TStackSize;
       ///< Structure that will hold the TCB of the task being created
@@ -298,7 +430,7 @@ namespace rtos
    public:
       TaskHandle_t operator*() { return handle; }
 
-      Task(delegator_t &&delegate) : delegator{delegate}
+      Task(delegator_t &&delegate) : TaskRegistry{stack_size}, delegator{delegate}
       {
          /* Create the task without using any dynamic memory allocation. */
          handle = xTaskCreateStatic(
@@ -513,31 +645,26 @@ namespace rtos
 
       bool start_from_isr( tick_t period, bool periodic = false )
       {
-         bool        retval;
-         BaseType_t *pxHigherPriorityTaskWoken;
+         bool       retval;
+         BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 
          vTimerSetReloadMode( handle, periodic ? pdTRUE : pdFALSE );
 
-         retval = xTimerChangePeriodFromISR( handle, period, pxHigherPriorityTaskWoken ) == pdFAIL
+         retval = xTimerChangePeriodFromISR( handle, period, &xHigherPriorityTaskWoken ) == pdFAIL
                      ? false
                      : true;
 
-         // Yield if this has cause a task to get moved up
-         if ( pxHigherPriorityTaskWoken )
-         {
-            portYIELD();
-         }
-
          // Carry on only if succesfull
          if ( retval )
          {
             retval =
-               xTimerStartFromISR( handle, pxHigherPriorityTaskWoken ) == pdFAIL ? false : true;
+               xTimerStartFromISR( handle, &xHigherPriorityTaskWoken ) == pdFAIL ? false : true;
+         }
 
-            if ( pxHigherPriorityTaskWoken )
-            {
-               portYIELD();
-            }
+         // Yield if this has cause a task to get moved up
+         if ( xHigherPriorityTaskWoken )
+         {
+            portYIELD();
          }
 
          return retval;
@@ -550,12 +677,12 @@ namespace rtos
 
       bool stop_from_isr()
       {
-         bool        retval;
-         BaseType_t *pxHigherPriorityTaskWoken;
+         bool       retval;
+         BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 
-         retval = xTimerStopFromISR( handle, pxHigherPriorityTaskWoken ) == pdFALSE ? false : true;
+         retval = xTimerStopFromISR( handle, &xHigherPriorityTaskWoken ) == pdFALSE ? false : true;
 
-         if ( pxHigherPriorityTaskWoken )
+         if ( xHigherPriorityTaskWoken )
          {
             portYIELD();
          }
@@ -570,12 +697,12 @@ namespace rtos
 
       bool reset_from_isr()
       {
-         bool        retval;
-         BaseType_t *pxHigherPriorityTaskWoken;
+         bool       retval;
+         BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 
-         retval = xTimerResetFromISR( handle, pxHigherPriorityTaskWoken ) == pdFALSE ? false : true;
+         retval = xTimerResetFromISR( handle, &xHigherPriorityTaskWoken ) == pdFALSE ? false : true;
 
-         if ( pxHigherPriorityTaskWoken )
+         if ( xHigherPriorityTaskWoken )
          {
             portYIELD();
          }
@@ -590,15 +717,15 @@ namespace rtos
 
       bool set_period_from_isr( tick_t NewPeriod )
       {
-         bool        retval;
-         BaseType_t *pxHigherPriorityTaskWoken;
+         bool       retval;
+         BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 
          retval =
-            xTimerChangePeriodFromISR( handle, NewPeriod, pxHigherPriorityTaskWoken ) == pdFALSE
+            xTimerChangePeriodFromISR( handle, NewPeriod, &xHigherPriorityTaskWoken ) == pdFALSE
                ? false
                : true;
 
-         if ( pxHigherPriorityTaskWoken )
+         if ( xHigherPriorityTaskWoken )
          {
             portYIELD();
          }
@@ -0,0 +1,70 @@
+/******************************************************************************
+The MIT License(MIT)
+https://github.com/adarwoo/cyclo
+
+Copyright(c) 2021 Guillaume ARRECKX - software@arreckx.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+******************************************************************************/
+#ifndef timebase_hpp_included
+#define timebase_hpp_included
+/**
+ * @file
+ * Free running 32 bits microsecond timebase, for timestamps and measurements.
+ *
+ * Two timers are chained through the event system: the low timer counts the
+ *  peripheral clock / 32 (1us), and the high timer counts its overflows.
+ * No interrupt is involved, and the count wraps every ~71 minutes - so always
+ *  compare the differences of two times.
+ * In the simulation, the time comes from the monotonic clock.
+ *
+ * The timebase also drives the run time statistics of the kernel. The run time
+ *  counter is the timebase, less the time spent in the interrupts holding an
+ *  IsrProbe, so this time is reported apart rather than charged to the task
+ *  the interrupt happened to break into.
+ */
+#include <cstdint>
+
+
+namespace rtos
+{
+   ///< Start the timebase. Called once at boot, before the scheduler starts
+   void start_timebase();
+
+   ///< @return The time in microseconds. Safe from tasks and interrupts
+   uint32_t now_us();
+
+   /**
+    * Account for the time spent in an interrupt handler.
+    * Create one first thing in the handler. Nested interrupts are counted once.
+    * The handlers written in C use isr_probe.h instead.
+    */
+   class IsrProbe
+   {
+   public:
+      IsrProbe();
+      ~IsrProbe();
+   };
+
+   ///< @return The time spent in the probed interrupts in microseconds
+   uint32_t isr_time_us();
+
+   ///< @return The number of probed interrupts
+   uint16_t isr_count();
+}  // namespace rtos
+
+#endif  // ndef timebase_hpp_included
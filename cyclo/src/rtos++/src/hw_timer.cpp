@@ -0,0 +1,482 @@
+/******************************************************************************
+The MIT License(MIT)
+https://github.com/adarwoo/cyclo
+
+Copyright(c) 2021 Guillaume ARRECKX - software@arreckx.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+******************************************************************************/
+
+/*
+ * hw_timer.cpp
+ *
+ * The times are read from the 32 bits microsecond timebase. The compare channel A
+ *  of its low timer is enabled when the first expiry falls within the current
+ *  16 bits period - else the overflow interrupt of the low timer re-arms it.
+ * The interrupts run on the stack of the interrupted task and return to it. Any
+ *  task they wake is switched to by the next tick.
+ * When the ready list could not be pended to the timer daemon, the compare is set
+ *  retry_counts ahead to try again.
+ * In the simulation, a high priority task plays the interrupt, with a tick
+ *  resolution only.
+ */
+#include <hw_timer.hpp>
+#include <timebase.hpp>
+
+#include "asx.h"
+
+
+namespace rtos
+{
+   namespace
+   {
+      ///< Microseconds per count of the timebase
+      constexpr uint32_t us_per_count = 1;
+
+      ///< Least number of counts ahead to set the compare to, so it is not missed
+      constexpr int32_t min_lead = 4;
+
+      ///< Counts before retrying to pend the ready list to a full daemon queue
+      constexpr int32_t retry_counts = 1000;
+
+#ifdef _POSIX
+      ///< Wakes the simulated interrupt on a change
+      Signal wakeup;
+#endif
+   }  // namespace
+
+   HwTimer          *HwTimer::head         = nullptr;
+   HwTimer          *HwTimer::ready_head   = nullptr;
+   HwTimer          *HwTimer::ready_tail   = nullptr;
+   bool              HwTimer::drain_queued = false;
+   HwTimer *volatile HwTimer::running      = nullptr;
+
+   HwTimer::HwTimer( callback_t callback, context_t context )
+      : prev{ nullptr }
+      , next{ nullptr }
+      , expiry{ 0 }
+      , period{ 0 }
+      , callback{ callback }
+      , context{ context }
+      , next_ready{ nullptr }
+      , ready{ false }
+   {
+      init();
+   }
+
+   /**
+    *  Stop the timer, and wait for its deferred callback to return if being called
+    *  by the timer daemon. A callback may delete its own timer.
+    */
+   HwTimer::~HwTimer()
+   {
+      stop();
+
+      if ( xTaskGetCurrentTaskHandle() != xTimerGetTimerDaemonTaskHandle() )
+      {
+         while ( running == this )
+         {
+            vTaskDelay( 1 );
+         }
+      }
+   }
+
+   /**
+    *  Start or restart the timer.
+    *
+    *  @param delay_us Delay to the first expiry, rounded up to the timer resolution.
+    *  @param periodic If true, the timer is restarted on every expiry with the same delay.
+    */
+   void HwTimer::start( uint32_t delay_us, bool periodic )
+   {
+      taskENTER_CRITICAL();
+      schedule( delay_us, periodic );
+      taskEXIT_CRITICAL();
+
+      kick();
+   }
+
+   void HwTimer::start_from_isr( uint32_t delay_us, bool periodic )
+   {
+      UBaseType_t mask = taskENTER_CRITICAL_FROM_ISR();
+      schedule( delay_us, periodic );
+      taskEXIT_CRITICAL_FROM_ISR( mask );
+
+      kick_from_isr();
+   }
+
+   void HwTimer::stop()
+   {
+      taskENTER_CRITICAL();
+      cancel();
+      unready();
+      arm();
+      taskEXIT_CRITICAL();
+
+      kick();
+   }
+
+   void HwTimer::stop_from_isr()
+   {
+      UBaseType_t mask = taskENTER_CRITICAL_FROM_ISR();
+      cancel();
+      unready();
+      arm();
+      taskEXIT_CRITICAL_FROM_ISR( mask );
+
+      kick_from_isr();
+   }
+
+   uint32_t HwTimer::remaining_us() const
+   {
+      int32_t left = 0;
+
+      taskENTER_CRITICAL();
+
+      if ( is_active() )
+      {
+         left = expiry - now();
+      }
+
+      taskEXIT_CRITICAL();
+
+      return ( left > 0 ) ? left * us_per_count : 0;
+   }
+
+   void HwTimer::schedule( uint32_t delay_us, bool periodic )
+   {
+      uint32_t counts = delay_us / us_per_count + ( delay_us % us_per_count ? 1 : 0 );
+
+      if ( counts == 0 )
+      {
+         counts = 1;
+      }
+
+      cancel();
+      unready();
+
+      period = periodic ? counts : 0;
+      expiry = now() + counts;
+
+      link();
+      arm();
+   }
+
+   void HwTimer::link()
+   {
+      HwTimer *after  = nullptr;
+      HwTimer *before = head;
+
+      // The times wrap, so compare the differences. Equal expiries are kept in order
+      while ( before and int32_t( before->expiry - expiry ) <= 0 )
+      {
+         after  = before;
+         before = before->next;
+      }
+
+      prev = after;
+      next = before;
+
+      if ( after )
+      {
+         after->next = this;
+      }
+      else
+      {
+         head = this;
+      }
+
+      if ( before )
+      {
+         before->prev = this;
+      }
+   }
+
+   void HwTimer::cancel()
+   {
+      if ( not is_active() )
+      {
+         return;
+      }
+
+      if ( prev )
+      {
+         prev->next = next;
+      }
+      else
+      {
+         head = next;
+      }
+
+      if ( next )
+      {
+         next->prev = prev;
+      }
+
+      prev = next = nullptr;
+   }
+
+   void HwTimer::unready()
+   {
+      if ( not ready )
+      {
+         return;
+      }
+
+      HwTimer *before = nullptr;
+
+      for ( HwTimer *timer = ready_head; timer != this; timer = timer->next_ready )
+      {
+         before = timer;
+      }
+
+      if ( before )
+      {
+         before->next_ready = next_ready;
+      }
+      else
+      {
+         ready_head = next_ready;
+      }
+
+      if ( ready_tail == this )
+      {
+         ready_tail = before;
+      }
+
+      next_ready = nullptr;
+      ready      = false;
+   }
+
+   void HwTimer::fire()
+   {
+      if ( context == context_t::isr )
+      {
+         callback();
+      }
+      else if ( not ready )
+      {
+         // A periodic timer already in the list is only called once
+         if ( ready_tail )
+         {
+            ready_tail->next_ready = this;
+         }
+         else
+         {
+            ready_head = this;
+         }
+
+         ready_tail = this;
+         ready      = true;
+      }
+   }
+
+   void HwTimer::expire()
+   {
+      uint32_t time = now();
+
+      while ( head and int32_t( head->expiry - time ) <= 0 )
+      {
+         HwTimer *timer = head;
+
+         timer->cancel();
+
+         if ( timer->period )
+         {
+            timer->expiry += timer->period;
+            timer->link();
+         }
+
+         timer->fire();
+      }
+   }
+
+   bool HwTimer::defer()
+   {
+      if ( ready_head and not drain_queued )
+      {
+         BaseType_t woken = pdFALSE;
+
+         // The task woken is switched to by the next tick
+         drain_queued = ( xTimerPendFunctionCallFromISR( &HwTimer::drain, nullptr, 0, &woken ) == pdPASS );
+
+         return drain_queued;
+      }
+
+      return true;
+   }
+
+   void HwTimer::drain( void *, uint32_t )
+   {
+      HwTimer *timer;
+
+      do
+      {
+         taskENTER_CRITICAL();
+
+         timer = ready_head;
+
+         if ( timer )
+         {
+            ready_head = timer->next_ready;
+
+            if ( ready_head == nullptr )
+            {
+               ready_tail = nullptr;
+            }
+
+            timer->next_ready = nullptr;
+            timer->ready      = false;
+         }
+         else
+         {
+            // The next expiry pends a new call
+            drain_queued = false;
+         }
+
+         running = timer;
+
+         taskEXIT_CRITICAL();
+
+         if ( timer )
+         {
+            timer->callback();
+         }
+      } while ( timer );
+   }
+
+   uint32_t HwTimer::now() { return now_us() / us_per_count; }
+
+#ifdef _POSIX
+   void HwTimer::init()
+   {
+      // Created with the first timer
+      static auto task = Task<typestring_is( "hwtimer" ), 0, priority_t::high>(
+         etl::delegate<void()>::create<&HwTimer::service>() );
+
+      (void)task;
+   }
+
+   void HwTimer::arm() {}
+
+   void HwTimer::kick() { wakeup.give(); }
+
+   void HwTimer::kick_from_isr() { wakeup.give_from_isr( nullptr ); }
+
+   void HwTimer::service()
+   {
+      while ( true )
+      {
+         tick_t timeout = tick::infinite;
+
+         taskENTER_CRITICAL();
+
+         if ( head )
+         {
+            int32_t left = head->expiry - now();
+
+            timeout = ( left > 0 ) ? tick::from_ms( left * us_per_count / 1000 ) + 1 : 0;
+         }
+
+         // Retry the pending of the ready list on the next tick
+         if ( ready_head and not drain_queued and timeout != 0 )
+         {
+            timeout = 1;
+         }
+
+         taskEXIT_CRITICAL();
+
+         if ( timeout )
+         {
+            wakeup.wait( timeout );
+         }
+
+         taskENTER_CRITICAL();
+         expire();
+         defer();
+         taskEXIT_CRITICAL();
+      }
+   }
+#else
+   void HwTimer::init()
+   {
+      static bool initialised = false;
+
+      if ( initialised )
+      {
+         return;
+      }
+
+      initialised = true;
+
+      // The timer itself is run by the timebase
+      tc_enable_cc_channels( &HWTIMER_TC, TC_CCAEN );
+
+      tc_set_overflow_interrupt_callback( &HWTIMER_TC, [] {
+         IsrProbe probe;
+         arm();
+      } );
+
+      tc_set_cca_interrupt_callback( &HWTIMER_TC, [] {
+         IsrProbe probe;
+
+         expire();
+         defer();
+         arm();
+      } );
+
+      tc_set_overflow_interrupt_level( &HWTIMER_TC, TC_INT_LVL_MED );
+   }
+
+   void HwTimer::arm()
+   {
+      bool retry = ( ready_head and not drain_queued );
+
+      if ( head or retry )
+      {
+         uint32_t time   = now();
+         uint32_t target = head ? head->expiry : time + retry_counts;
+
+         if ( retry and int32_t( target - time ) > retry_counts )
+         {
+            target = time + retry_counts;
+         }
+
+         if ( int32_t( target - time ) < min_lead )
+         {
+            target = time + min_lead;
+         }
+
+         // Beyond the current period, the overflow interrupt will re-arm
+         if ( ( target >> 16 ) == ( time >> 16 ) )
+         {
+            tc_write_cc( &HWTIMER_TC, TC_CCA, uint16_t( target ) );
+            tc_clear_cc_interrupt( &HWTIMER_TC, TC_CCA );
+            tc_set_cca_interrupt_level( &HWTIMER_TC, TC_INT_LVL_MED );
+
+            return;
+         }
+      }
+
+      tc_set_cca_interrupt_level( &HWTIMER_TC, TC_INT_LVL_OFF );
+   }
+
+   void HwTimer::kick() {}
+
+   void HwTimer::kick_from_isr() {}
+#endif
+}  // namespace rtos
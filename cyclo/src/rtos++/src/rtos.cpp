@@ -29,9 +29,135 @@ SOFTWARE.
  */
 
 #include <rtos.hpp>
+#include <timebase.hpp>
 
 namespace rtos
 {
+   namespace
+   {
+      ///< Counters of the kernel tasks and of the interrupts at the previous report
+      TaskRegistry::Marks idle_marks{}, timer_marks{}, isr_marks{};
+
+      StackUsage get_stack_usage( TaskHandle_t handle, size_t depth )
+      {
+         return StackUsage{
+            pcTaskGetName( handle ),
+            depth * sizeof( StackType_t ),
+            uxTaskGetStackHighWaterMark( handle ) * sizeof( StackType_t ) };
+      }
+
+      ///< @return The counters of a task, or of the interrupts if the handle is null
+      TaskRegistry::Marks get_counters( TaskHandle_t handle )
+      {
+         if ( handle == nullptr )
+         {
+            return TaskRegistry::Marks{ isr_time_us(), isr_count() };
+         }
+
+         TaskStatus_t status;
+
+         // The state is not used - passing one saves looking it up
+         vTaskGetInfo( handle, &status, pdFALSE, eReady );
+
+         // The tag counts the switches (see FreeRTOSConfig.h)
+         return TaskRegistry::Marks{
+            status.ulRunTimeCounter, uint16_t( uintptr_t( xTaskGetApplicationTaskTag( handle ) ) ) };
+      }
+   }  // namespace
+
+   TaskRegistry *TaskRegistry::first = nullptr;
+
+   TaskRegistry::TaskRegistry( size_t depth )
+      : next{ first }, marks{ 0, 0 }, handle{ nullptr }, stack_depth{ depth }
+   {
+      first = this;
+   }
+
+   /**
+    *  Report the stack usage of all the tasks.
+    *  The tasks are reported from the most recently created, followed by the idle
+    *  and timer tasks once the scheduler is started.
+    *
+    *  @param report Function called with the usage of each task.
+    */
+   void TaskRegistry::report_stack_usage( report_t report )
+   {
+      for ( auto task = first; task != nullptr; task = task->next )
+      {
+         report( get_stack_usage( task->handle, task->stack_depth ) );
+      }
+
+      // The kernel tasks are created with the scheduler
+      if ( xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED )
+      {
+         report( get_stack_usage( xTaskGetIdleTaskHandle(), configMINIMAL_STACK_SIZE ) );
+         report( get_stack_usage( xTimerGetTimerDaemonTaskHandle(), configTIMER_TASK_STACK_DEPTH ) );
+      }
+   }
+
+   /**
+    *  Report the statistics of all the tasks, and of the interrupts, since the previous call.
+    *  The load is the share of the run time counted by all the entries, so it adds up to 100%.
+    *
+    *  @param report Function called with the statistics of each task.
+    */
+   void TaskRegistry::report_task_stats( stats_report_t report )
+   {
+      // Call the function with each task, its stack depth and its marks. The interrupts come last
+      auto for_each = [&]( auto &&fn ) {
+         for ( auto task = first; task != nullptr; task = task->next )
+         {
+            fn( task->handle, task->stack_depth, task->marks );
+         }
+
+         if ( xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED )
+         {
+            fn( xTaskGetIdleTaskHandle(), configMINIMAL_STACK_SIZE, idle_marks );
+            fn( xTimerGetTimerDaemonTaskHandle(), configTIMER_TASK_STACK_DEPTH, timer_marks );
+         }
+
+         fn( nullptr, 0, isr_marks );
+      };
+
+      uint32_t total = 0;
+
+      for_each( [&]( TaskHandle_t handle, size_t, Marks &marks ) {
+         total += get_counters( handle ).run_time - marks.run_time;
+      } );
+
+      for_each( [&]( TaskHandle_t handle, size_t depth, Marks &marks ) {
+         Marks     now = get_counters( handle );
+         TaskStats stats{};
+
+         if ( handle )
+         {
+            static_cast<StackUsage &>( stats ) = get_stack_usage( handle, depth );
+         }
+         else
+         {
+            // The probed interrupts: HwTimer, keypad, NO/NC, TWI master and USB.
+            // The tick is not probed, and is charged to the task it breaks into
+            stats.name = "ISR";
+         }
+
+         stats.run_time = now.run_time - marks.run_time;
+         stats.switches = now.switches - marks.switches;
+
+         // Avoid overflowing 32 bits past a few seconds
+         if ( total >= 1000 )
+         {
+            stats.load = etl::min<uint32_t>( stats.run_time / ( total / 1000 ), 1000 );
+         }
+         else if ( total )
+         {
+            stats.load = stats.run_time * 1000 / total;
+         }
+
+         marks = now;
+         report( stats );
+      } );
+   }
+
    /**
     *  Acquire (take) a semaphore.
     *
@@ -159,19 +285,154 @@ namespace rtos
 
 
    /**
-    *  Constructor
-    *  @note Do not construct inside an ISR! This includes creating
-    *  local instances of this object.
+    *  Give the signal.
+    *  If no task waited yet, the signal is kept for the first wait.
     */
-   Tasklet::Tasklet()
+   void Signal::give()
    {
-      DtorLock = xSemaphoreCreateBinaryStatic( &xSemaphoreBuffer );
+      TaskHandle_t task;
 
-      assert( DtorLock );
+      taskENTER_CRITICAL();
+      task = waiter;
 
-      xSemaphoreGive( DtorLock );
+      if ( task == nullptr )
+      {
+         pending = true;
+      }
+      taskEXIT_CRITICAL();
+
+      if ( task )
+      {
+         xTaskNotifyGiveIndexed( task, notification_index );
+      }
    }
 
+   /**
+    *  Give the signal from ISR context.
+    *
+    *  @param pxHigherPriorityTaskWoken Did this operation result in a
+    *         rescheduling event. Can be null.
+    */
+   void Signal::give_from_isr( BaseType_t *pxHigherPriorityTaskWoken )
+   {
+      TaskHandle_t task;
+      UBaseType_t  mask = taskENTER_CRITICAL_FROM_ISR();
+
+      task = waiter;
+
+      if ( task == nullptr )
+      {
+         pending = true;
+      }
+
+      taskEXIT_CRITICAL_FROM_ISR( mask );
+
+      if ( task )
+      {
+         vTaskNotifyGiveIndexedFromISR( task, notification_index, pxHigherPriorityTaskWoken );
+      }
+   }
+
+   /**
+    *  Wait for the signal. The calling task becomes the waiter.
+    *
+    *  @param timeout How long to wait for the signal.
+    *  @return true if the signal was given, false if it timed out.
+    */
+   bool Signal::wait( tick_t timeout )
+   {
+      bool given;
+
+      taskENTER_CRITICAL();
+      waiter  = xTaskGetCurrentTaskHandle();
+      given   = pending;
+      pending = false;
+      taskEXIT_CRITICAL();
+
+      return given or ulTaskNotifyTakeIndexed( notification_index, pdTRUE, timeout ) != 0;
+   }
+
+   /**
+    *  Set some flags.
+    *  If no task waited yet, the flags are kept for the first wait.
+    */
+   void EventFlags::set( uint32_t flags )
+   {
+      TaskHandle_t task;
+
+      taskENTER_CRITICAL();
+      task = waiter;
+
+      if ( task == nullptr )
+      {
+         pending |= flags;
+      }
+      taskEXIT_CRITICAL();
+
+      if ( task )
+      {
+         xTaskNotifyIndexed( task, notification_index, flags, eSetBits );
+      }
+   }
+
+   /**
+    *  Set some flags from ISR context.
+    *
+    *  @param pxHigherPriorityTaskWoken Did this operation result in a
+    *         rescheduling event. Can be null.
+    */
+   void EventFlags::set_from_isr( uint32_t flags, BaseType_t *pxHigherPriorityTaskWoken )
+   {
+      TaskHandle_t task;
+      UBaseType_t  mask = taskENTER_CRITICAL_FROM_ISR();
+
+      task = waiter;
+
+      if ( task == nullptr )
+      {
+         pending |= flags;
+      }
+
+      taskEXIT_CRITICAL_FROM_ISR( mask );
+
+      if ( task )
+      {
+         xTaskNotifyIndexedFromISR(
+            task, notification_index, flags, eSetBits, pxHigherPriorityTaskWoken );
+      }
+   }
+
+   /**
+    *  Wait for any flag. The calling task becomes the waiter.
+    *
+    *  @param timeout How long to wait for a flag.
+    *  @return The flags set, which are all cleared, or 0 if it timed out.
+    */
+   uint32_t EventFlags::wait( tick_t timeout )
+   {
+      uint32_t flags;
+
+      taskENTER_CRITICAL();
+      waiter  = xTaskGetCurrentTaskHandle();
+      flags   = pending;
+      pending = 0;
+      taskEXIT_CRITICAL();
+
+      if ( flags == 0 )
+      {
+         xTaskNotifyWaitIndexed( notification_index, 0, UINT32_MAX, &flags, timeout );
+      }
+
+      return flags;
+   }
+
+   /**
+    *  Constructor
+    *  @note Do not construct inside an ISR! This includes creating
+    *  local instances of this object.
+    */
+   Tasklet::Tasklet() : pending{ 0 } {}
+
    /**
     *  Destructor
     *  @note Do not delete inside an ISR! This includes the automatic
@@ -192,7 +453,9 @@ namespace rtos
    {
       BaseType_t rc;
 
-      xSemaphoreTake( DtorLock, portMAX_DELAY );
+      taskENTER_CRITICAL();
+      ++pending;
+      taskEXIT_CRITICAL();
 
       rc= xTimerPendFunctionCall( TaskletAdapterFunction, this, parameter, CmdTimeout );
 
@@ -202,7 +465,7 @@ namespace rtos
       }
       else
       {
-         xSemaphoreGive( DtorLock );
+         done();
          return false;
       }
    }
@@ -220,10 +483,12 @@ namespace rtos
     */
    bool Tasklet::schedule_from_isr( uint32_t parameter )
    {
-      BaseType_t pxHigherPriorityTaskWoken;
+      BaseType_t pxHigherPriorityTaskWoken = pdFALSE;
       BaseType_t rc;
+      UBaseType_t mask = taskENTER_CRITICAL_FROM_ISR();
 
-      xSemaphoreTake( DtorLock, portMAX_DELAY );
+      ++pending;
+      taskEXIT_CRITICAL_FROM_ISR( mask );
 
       rc= xTimerPendFunctionCallFromISR(
          TaskletAdapterFunction, this, parameter, &pxHigherPriorityTaskWoken );
@@ -239,7 +504,8 @@ namespace rtos
       }
       else
       {
-         xSemaphoreGive( DtorLock );
+         done_from_isr( &pxHigherPriorityTaskWoken );
+
          return false;
       }
    }
@@ -250,8 +516,47 @@ namespace rtos
     */
    void Tasklet::check_for_safe_delete()
    {
-      xSemaphoreTake( DtorLock, portMAX_DELAY );
-      vSemaphoreDelete( DtorLock );
+      while ( pending )
+      {
+         idle.wait();
+      }
+   }
+
+   /**
+    *  Account for a scheduled call which has run, or could not be scheduled.
+    */
+   void Tasklet::done()
+   {
+      bool last;
+
+      taskENTER_CRITICAL();
+      last = ( --pending == 0 );
+      taskEXIT_CRITICAL();
+
+      if ( last )
+      {
+         idle.give();
+      }
+   }
+
+   /**
+    *  Account for a call which could not be scheduled, from ISR context.
+    *
+    *  @param pxHigherPriorityTaskWoken Did giving the idle signal result in a
+    *         rescheduling event.
+    */
+   void Tasklet::done_from_isr( BaseType_t *pxHigherPriorityTaskWoken )
+   {
+      bool        last;
+      UBaseType_t mask = taskENTER_CRITICAL_FROM_ISR();
+
+      last = ( --pending == 0 );
+      taskEXIT_CRITICAL_FROM_ISR( mask );
+
+      if ( last )
+      {
+         idle.give_from_isr( pxHigherPriorityTaskWoken );
+      }
    }
 
    /**
@@ -264,6 +569,6 @@ namespace rtos
    {
       Tasklet *tasklet= static_cast< Tasklet * >( ref );
       tasklet->run( parameter );
-      xSemaphoreGive( tasklet->DtorLock );
+      tasklet->done();
    }
 }  // namespace rtos
\ No newline at end of file
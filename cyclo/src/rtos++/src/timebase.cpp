@@ -0,0 +1,181 @@
+/******************************************************************************
+The MIT License(MIT)
+https://github.com/adarwoo/cyclo
+
+Copyright(c) 2021 Guillaume ARRECKX - software@arreckx.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+******************************************************************************/
+
+/*
+ * timebase.cpp
+ *
+ * Event channel 0 divides the 32MHz peripheral clock by 32, and clocks the low timer.
+ * Event channel 1 carries the overflows of the low timer, and clocks the high timer.
+ * The probes record the time the outermost interrupt started. While in an interrupt,
+ *  the run time counter stays at that time, so it never goes backward, even when
+ *  the interrupt switches the context.
+ */
+#include <timebase.hpp>
+#include <isr_probe.h>
+
+#include "asx.h"
+
+#ifdef _POSIX
+#  include <time.h>
+#endif
+
+
+namespace rtos
+{
+#ifdef _POSIX
+   IsrProbe::IsrProbe() {}
+
+   IsrProbe::~IsrProbe() {}
+
+   uint32_t isr_time_us() { return 0; }
+
+   uint16_t isr_count() { return 0; }
+
+   void start_timebase() {}
+
+   uint32_t now_us()
+   {
+      struct timespec ts;
+
+      clock_gettime( CLOCK_MONOTONIC, &ts );
+
+      return uint32_t( ts.tv_sec * 1000000ull + ts.tv_nsec / 1000 );
+   }
+#else
+   namespace
+   {
+      ///< Depth of the probed interrupts
+      volatile uint8_t depth = 0;
+
+      ///< Time the outermost interrupt started
+      volatile uint32_t isr_start = 0;
+
+      ///< Time spent in the interrupts
+      volatile uint32_t isr_total = 0;
+
+      ///< Number of interrupts
+      volatile uint16_t isr_entries = 0;
+   }  // namespace
+
+   IsrProbe::IsrProbe() { isr_probe_enter(); }
+
+   IsrProbe::~IsrProbe() { isr_probe_exit(); }
+
+   uint32_t isr_time_us()
+   {
+      irqflags_t flags = cpu_irq_save();
+      uint32_t   total = isr_total;
+      cpu_irq_restore( flags );
+
+      return total;
+   }
+
+   uint16_t isr_count()
+   {
+      irqflags_t flags = cpu_irq_save();
+      uint16_t   count = isr_entries;
+      cpu_irq_restore( flags );
+
+      return count;
+   }
+
+   void start_timebase()
+   {
+      sysclk_enable_module( SYSCLK_PORT_GEN, SYSCLK_EVSYS );
+
+      EVSYS.CH0MUX = EVSYS_CHMUX_PRESCALER_32_gc;
+      EVSYS.CH1MUX = TIMEBASE_LO_OVF_EVENT;
+
+      tc_enable( &TIMEBASE_HI_TC );
+      tc_set_wgm( &TIMEBASE_HI_TC, TC_WG_NORMAL );
+      tc_write_period( &TIMEBASE_HI_TC, 0xffff );
+      tc_write_clock_source( &TIMEBASE_HI_TC, TC_CLKSEL_EVCH1_gc );
+
+      tc_enable( &TIMEBASE_LO_TC );
+      tc_set_wgm( &TIMEBASE_LO_TC, TC_WG_NORMAL );
+      tc_write_period( &TIMEBASE_LO_TC, 0xffff );
+      tc_write_clock_source( &TIMEBASE_LO_TC, TC_CLKSEL_EVCH0_gc );
+   }
+
+   uint32_t now_us()
+   {
+      uint16_t high, low;
+
+      // The interrupts share the 16 bits TEMP register of the low timer (hw_timer)
+      irqflags_t flags = cpu_irq_save();
+
+      // Read again if the low timer wrapped in between
+      do
+      {
+         high = TIMEBASE_HI_TC.CNT;
+         low  = TIMEBASE_LO_TC.CNT;
+      } while ( high != TIMEBASE_HI_TC.CNT );
+
+      cpu_irq_restore( flags );
+
+      return ( uint32_t( high ) << 16 ) | low;
+   }
+#endif
+}  // namespace rtos
+
+
+#ifdef _POSIX
+void isr_probe_enter( void ) {}
+
+void isr_probe_exit( void ) {}
+#else
+void isr_probe_enter( void )
+{
+   irqflags_t flags = cpu_irq_save();
+
+   if ( rtos::depth++ == 0 )
+   {
+      rtos::isr_start = rtos::now_us();
+   }
+
+   ++rtos::isr_entries;
+   cpu_irq_restore( flags );
+}
+
+void isr_probe_exit( void )
+{
+   irqflags_t flags = cpu_irq_save();
+
+   if ( --rtos::depth == 0 )
+   {
+      rtos::isr_total += rtos::now_us() - rtos::isr_start;
+   }
+
+   cpu_irq_restore( flags );
+}
+
+/** Run time counter of the kernel statistics (see FreeRTOSConfig.h) */
+extern "C" uint32_t rtos_run_time_counter( void )
+{
+   irqflags_t flags = cpu_irq_save();
+   uint32_t   now   = ( rtos::depth ? rtos::isr_start : rtos::now_us() ) - rtos::isr_total;
+   cpu_irq_restore( flags );
+
+   return now;
+}
+#endif
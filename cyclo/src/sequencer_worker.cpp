@@ -23,10 +23,10 @@ SOFTWARE.
 
 #include "sequencer_worker.hpp"
 
-#include <logger.h>
+#include "edge_log.hpp"
 
+#include <logger.h>
 
-using namespace rtos::tick;
 
 namespace
 {
@@ -35,9 +35,7 @@ namespace
 
 
 SequencerWorker::SequencerWorker( ProgramManager &pgm_man )
-   : timer{ [] { fx::publish( msg::SequenceNext{} ); } }
-   , timer_counter{ 100 }
-   , ticks_left{ 0 }
+   : ms_left{ 0 }
    , pgm_man{ pgm_man }
 {}
 
@@ -54,29 +52,33 @@ void SequencerWorker::on_receive( const msg::StartProgram &msg )
 
    if ( msg.from_start )
    {
+      // A restart drops the step of the previous run, or both would advance the program
+      next_step.cancel();
+
+      Program &pgm = pgm_man.acquire();
+
       // Reset the counter
       pgm_man.set_counter( -1 );
 
       // Is it a loop ?
-      if ( pgm_man.get_active_program().back().command == Command::loop )
+      if ( pgm.back().command == Command::loop )
       {
          pgm_man.set_counter( 0 );
       }
 
       // Start from the start
-      pgm_man.get_active_program().start();
+      pgm.start();
 
       // Update the GUI
       fx::publish( msg::CounterUpdate{} );
 
-      // Reset the number of ticks left. This is used when pausing,
+      // Reset the time left. This is used when pausing,
       // so we resume with the actual time left
-      ticks_left = 0;
+      ms_left = 0;
    }
-   else if ( ticks_left )
+   else if ( ms_left )
    {
-      timer.set_param( timer_counter );
-      timer.start(ticks_left);
+      next_step = fx::publish_after( msg::SequenceNext{}, ms_left );
 
       return;
    }
@@ -90,66 +92,67 @@ void SequencerWorker::on_receive( const msg::StopProgram &msg )
 {
    LOG_TRACE( DOM, "StopProgram" );
 
-   ticks_left = timer.get_time_left_until_expiry();
-
-   // Simple race prevention : invalidate the current timer instance
-   //  to prevent a race where the timer message is already in the queue
-   ++timer_counter;
+   ms_left = next_step.remaining_ms();
 
-   // Stop the timer
-   timer.stop();
+   // Cancelling also drops the step if already in the queue
+   next_step.cancel();
 }
 
 void SequencerWorker::on_receive( const msg::SequenceNext &msg )
 {
    LOG_TRACE( DOM, "SequenceNext" );
 
-   // Check the timer is still valid (avoid race)
-   if ( timer.get_param() == timer_counter )
-   {
-      execute_next();
-   }
+   // Delivered - the slot may be reused
+   next_step = fx::TimerHandle{};
+
+   execute_next();
 }
 
 void SequencerWorker::execute_next()
 {
    LOG_HEADER( DOM );
 
-   // Pick the first command and apply it
-   auto &pgm = pgm_man.get_active_program();
+   // Pick the first command and apply it. A newly loaded program is picked up here
+   auto &pgm = pgm_man.acquire();
 
    // Grab the first item and move the iterator
-   const Command *cmd = pgm.iterate();
+   auto step = pgm.next();
 
    // Make sure not the last
-   if ( cmd )
+   if ( step != pgm.end() )
    {
+      Command cmd = *step;
+
       // Execute the item
-      switch ( cmd->command )
+      switch ( cmd.command )
       {
-      case Command::close: pgm_man.get_contact().set( Contact::close ); break;
-      case Command::open: pgm_man.get_contact().set( Contact::open ); break;
+      case Command::close:
+         pgm_man.get_contact().set( Contact::close );
+         edge_log::record( edge_log::relay_close, step.index() );
+         break;
+      case Command::open:
+         pgm_man.get_contact().set( Contact::open );
+         edge_log::record( edge_log::relay_open, step.index() );
+         break;
       case Command::delay:
          // Do nothing
          break;
       case Command::loop:
          // Start all over
-         pgm_man.get_active_program().start();
+         pgm.start();
 
          pgm_man.set_counter( pgm_man.get_counter() + 1 );
          fx::publish( msg::CounterUpdate{} );
 
          // Avoid recursion - save the stack, save the trouble - post again
-         fx::publish( msg::SequenceNext{} );
+         next_step = fx::publish_after( msg::SequenceNext{}, 0 );
          return;
       }
 
       // If a delay exists
-      if ( cmd->delay_ms )
+      if ( cmd.ticks )
       {
-         // Fire a new timers
-         timer.set_param( ++timer_counter );
-         timer.start( rtos::tick::from_ms( cmd->delay_ms ) );
+         next_step = fx::publish_after( msg::SequenceNext{}, cmd.delay_ms() );
          return;
       }
    }
@@ -21,6 +21,7 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 ******************************************************************************/
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #include <progmem.h>
@@ -41,6 +42,7 @@ SOFTWARE.
 
 #define IOPORT_CREATE_PIN( port, pin ) ( port << 8 | pin )
 
+#define EEPROM_SIZE 2048
 #define EEPROM_PAGE_SIZE 32
 
 //
@@ -75,10 +77,14 @@ extern "C"
    void nvm_eeprom_atomic_write_page( uint8_t page_addr );
    void nvm_eeprom_load_page_to_buffer( const uint8_t *values );
    void nvm_eeprom_erase_page( uint8_t page_addr );
+   void nvm_eeprom_flush_buffer( void );
+   void nvm_eeprom_load_byte_to_buffer( uint8_t byte_addr, uint8_t value );
+   void nvm_eeprom_split_write_page( uint8_t page_addr );
 
    // UDI
    int udi_cdc_multi_putc( uint8_t port, int value );
    int udi_cdc_getc( void );
+   size_t udi_cdc_write_buf( const void *buf, size_t size );
 
    // CRC Emulation
    enum crc_16_32_t {
@@ -86,6 +92,9 @@ extern "C"
       CRC_32BIT,
    };
    uint32_t crc_io_checksum( void *data, uint16_t len, enum crc_16_32_t crc_16_32 );
+   void crc_io_checksum_byte_start( enum crc_16_32_t crc_16_32 );
+   void crc_io_checksum_byte_add( uint8_t data );
+   uint32_t crc_io_checksum_byte_stop( void );
 
 
 // Wdt
@@ -1,6 +1,7 @@
 #ifndef SSD1306_H_INCLUDED
 #define SSD1306_H_INCLUDED
 
+#include <stdbool.h>
 #include <stdint.h>
 
 // Force a framebuffer type
@@ -17,6 +18,8 @@ void ssd1306_set_column_address(uint8_t address);
 void ssd1306_write_data(uint8_t data);
 void ssd1306_write_data_buffer(const uint8_t *data, uint8_t size);
 uint8_t ssd1306_read_data();
+bool ssd1306_queue_data(uint8_t page, uint8_t column, const uint8_t *data, uint8_t size);
+uint8_t ssd1306_send_queued(void);
 
 #ifdef __cplusplus
 }
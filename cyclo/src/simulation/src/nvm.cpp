@@ -37,10 +37,16 @@ namespace
    const char *const DOM = "nvm";
 
    // EEProm content
-   uint8_t eeprom_memory[ 2048 ];
+   uint8_t eeprom_memory[ EEPROM_SIZE ];
 
    // EEProm page buffer
    uint8_t eeprom_page_buffer[ EEPROM_PAGE_SIZE ];
+
+   // Bytes of the page buffer loaded since the last flush (for split writes)
+   bool eeprom_page_loaded[ EEPROM_PAGE_SIZE ];
+
+   // CRC computed byte per byte
+   auto crc_io = etl::crc16{};
 }  // namespace
 
 // EEProm simulated memory
@@ -59,6 +65,16 @@ extern "C"
    {
       using ifs_t = std::ifstream;
 
+      // The memory is kept in sync with the file, so it is only read once
+      static bool loaded = false;
+
+      if ( loaded )
+      {
+         return;
+      }
+
+      loaded = true;
+
       // Read the whole file into the buffer
       auto ifs = ifs_t( "/tmp/eeprom.bin", ifs_t::binary );
 
@@ -72,15 +88,11 @@ extern "C"
       }
    }
 
-   void nvm_eeprom_atomic_write_page( uint8_t page )
+   // Write to whole memory back to the file
+   static void persist()
    {
-      LOG_TRACE(DOM, "Writing page %d", page);
       using ofs_t = std::ofstream;
 
-      // Transfer the buffer to the main memory
-      memcpy( eeprom_memory + EEPROM_PAGE_SIZE * page, eeprom_page_buffer, EEPROM_PAGE_SIZE );
-
-      // Write to whole buffer back
       auto ofs = ofs_t( "/tmp/eeprom.bin", ofs_t::binary | ofs_t::out );
 
       if ( ! ofs.good() )
@@ -92,6 +104,44 @@ extern "C"
       ofs.write( reinterpret_cast<char *>( eeprom_memory ), sizeof( eeprom_memory ) );
    }
 
+   void nvm_eeprom_atomic_write_page( uint8_t page )
+   {
+      LOG_TRACE(DOM, "Writing page %d", page);
+
+      // Transfer the buffer to the main memory
+      memcpy( eeprom_memory + EEPROM_PAGE_SIZE * page, eeprom_page_buffer, EEPROM_PAGE_SIZE );
+      persist();
+   }
+
+   void nvm_eeprom_flush_buffer( void )
+   {
+      std::fill_n( eeprom_page_loaded, EEPROM_PAGE_SIZE, false );
+   }
+
+   void nvm_eeprom_load_byte_to_buffer( uint8_t byte_addr, uint8_t value )
+   {
+      byte_addr %= EEPROM_PAGE_SIZE;
+      eeprom_page_buffer[ byte_addr ] = value;
+      eeprom_page_loaded[ byte_addr ] = true;
+   }
+
+   /** Write without erasing - only bits can be cleared. Only the loaded bytes are written */
+   void nvm_eeprom_split_write_page( uint8_t page )
+   {
+      LOG_TRACE( DOM, "Split writing page %d", page );
+
+      for ( uint8_t i = 0; i < EEPROM_PAGE_SIZE; ++i )
+      {
+         if ( eeprom_page_loaded[ i ] )
+         {
+            eeprom_memory[ EEPROM_PAGE_SIZE * page + i ] &= eeprom_page_buffer[ i ];
+         }
+      }
+
+      nvm_eeprom_flush_buffer();
+      persist();
+   }
+
    void nvm_eeprom_load_page_to_buffer( const uint8_t *values )
    {
       memcpy( eeprom_page_buffer, values, EEPROM_PAGE_SIZE );
@@ -112,6 +162,12 @@ extern "C"
       return crc.value();
    }
 
+   void crc_io_checksum_byte_start( enum crc_16_32_t crc_16_32 ) { crc_io.reset(); }
+
+   void crc_io_checksum_byte_add( uint8_t data ) { crc_io.add( data ); }
+
+   uint32_t crc_io_checksum_byte_stop( void ) { return crc_io.value(); }
+
    /**
     * \brief Erase EEPROM page.
     *
@@ -122,5 +178,6 @@ extern "C"
    void nvm_eeprom_erase_page( uint8_t page_addr )
    {
       memset( eeprom_memory + EEPROM_PAGE_SIZE * page_addr, 0xff, EEPROM_PAGE_SIZE );
+      persist();
    }
 }
\ No newline at end of file
@@ -32,6 +32,7 @@ SOFTWARE.
 // For the logger
 #include "asx.h"
 #include "keypad.h"
+#include "ram_budget.hpp"
 
 #include <rtos.hpp>
 
@@ -51,6 +52,27 @@ namespace
    auto task = rtos::Task<typestring_is( "keypad" )>(
       etl::delegate<void(void)>::create<scan_keys>()
    );
+
+   void log_stack_usage( const rtos::StackUsage &usage )
+   {
+      LOG_INFO(
+         DOM, "Stack of %-8s %5zu bytes, %5zu used", usage.name, usage.size,
+         usage.size - usage.unused );
+   }
+
+   void log_allocation( const char *name, size_t bytes )
+   {
+      LOG_INFO( DOM, "Static %-9s %5zu bytes (host sizes)", name, bytes );
+   }
+
+   ///< Report the stack usage of the tasks, and the static allocations, on leaving the simulator
+   void report_memory()
+   {
+      rtos::TaskRegistry::report_stack_usage(
+         rtos::TaskRegistry::report_t::create<log_stack_usage>() );
+
+      ram_budget::report( ram_budget::report_t::create<log_allocation>() );
+   }
 }  // namespace
 
 extern "C"
@@ -61,6 +83,7 @@ extern "C"
    {
       nvm_init();
       console_cdc_enabled( 0 );
+      atexit( report_memory );
    }
 
    bool ioport_get_pin_level( ioport_pin_t pin )
@@ -211,6 +234,15 @@ extern "C"
       return 0;
    }
 
+   size_t udi_cdc_write_buf( const void *buf, size_t size )
+   {
+      fwrite( buf, 1, size, stdout );
+      fflush( stdout );
+
+      // Returns the number of bytes not sent
+      return 0;
+   }
+
    int udi_cdc_getc( void )
    {
       char c;
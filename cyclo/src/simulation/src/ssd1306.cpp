@@ -218,4 +218,46 @@ extern "C" void ssd1306_write_data_buffer(const uint8_t *data, uint8_t size)
    }
 
    XPutImage( dpy, win, gc, img, 0, 0, 20, 20, 48, 64 );
-}
\ No newline at end of file
+}
+
+namespace
+{
+   ///< Spans queued for ssd1306_send_queued - sent at once in the simulation
+   struct Span
+   {
+      uint8_t        page;
+      uint8_t        column;
+      const uint8_t *data;
+      uint8_t        size;
+   } queue[ 16 ];
+
+   uint8_t queued = 0;
+}  // namespace
+
+extern "C" bool ssd1306_queue_data( uint8_t page, uint8_t column, const uint8_t *data, uint8_t size )
+{
+   if ( queued == sizeof( queue ) / sizeof( queue[ 0 ] ) )
+   {
+      return false;
+   }
+
+   queue[ queued++ ] = Span{ page, column, data, size };
+
+   return true;
+}
+
+extern "C" uint8_t ssd1306_send_queued( void )
+{
+   uint8_t const sent = queued;
+
+   for ( uint8_t i = 0; i < queued; ++i )
+   {
+      ssd1306_set_page_address( queue[ i ].page );
+      ssd1306_set_column_address( queue[ i ].column );
+      ssd1306_write_data_buffer( queue[ i ].data, queue[ i ].size );
+   }
+
+   queued = 0;
+
+   return sent;
+}
@@ -32,9 +32,7 @@ SOFTWARE.
 
 #include "asx.h"
 
-#include <etl/format_spec.h>
-#include <etl/string.h>
-#include <etl/to_string.h>
+#include <etl/algorithm.h>
 
 
 /** Contruct a manual program as o 1 minute and off 5 seconds */
@@ -43,25 +41,27 @@ ManualProgram::ManualProgram() : on_min{ 0 }, on_sec{ 0 }, off_min{ 0 }, off_sec
 
 UIModel::UIModel( ProgramManager &pm ) : program_manager{ pm }
 {
-   // Load the manual program. The programs manager guarantees it exists
-   program_manager.load( 0 );
+   // Read the manual program. The programs manager guarantees it exists.
+   // It is not loaded, as an autostart program may be running already
+   Program pgm;
 
-   // Import the manual program
-   const Program &pgm = program_manager.get_active_program();
-
-   Command itemClose = pgm.at( 0 );
-   Command itemOpen  = pgm.at( 1 );
-
-   auto to_min_sec = []( uint32_t ms, uint8_t &minutes ) {
-      // Discard ms
-      uint16_t seconds = ms / 1000;
-      minutes          = seconds / 60;
-      return seconds % 60;
-   };
-
-   // Work with seconds (not ms)
-   on_sec  = to_min_sec( itemClose.delay_ms, on_min );
-   off_sec = to_min_sec( itemOpen.delay_ms, off_min );
+   if ( program_manager.read( 0, pgm ) and pgm.size() >= 2 )
+   {
+      auto    step      = pgm.begin();
+      Command itemClose = *step++;
+      Command itemOpen  = *step;
+
+      auto to_min_sec = []( uint32_t ms, uint8_t &minutes ) {
+         // Discard ms
+         uint16_t seconds = ms / 1000;
+         minutes          = seconds / 60;
+         return seconds % 60;
+      };
+
+      // Work with seconds (not ms)
+      on_sec  = to_min_sec( itemClose.delay_ms(), on_min );
+      off_sec = to_min_sec( itemOpen.delay_ms(), off_min );
+   }
 
    // Get the index of the selected program
    program_index = program_manager.get_selected();
@@ -70,24 +70,20 @@ UIModel::UIModel( ProgramManager &pm ) : program_manager{ pm }
 ///< Persist the manual program to the EEProm
 void UIModel::store_manual_pgm()
 {
-   etl::string<22>  pgmStr{ "c " };  // 'c 00M 01s o 00M 00s *' = 21 + 1 \0
-   etl::format_spec format;
-
-   format.fill( '0' ).width( 2 ).decimal();
+   // As 'c 00M 01s o 00M 00s *', with the 1 second minimum delay of the parser
+   auto to_ticks = []( uint8_t minutes, uint8_t seconds ) -> uint32_t {
+      return Command::to_ticks( etl::max<uint32_t>( ( minutes * 60ul + seconds ) * 1000ul, 1000 ) );
+   };
 
-   etl::to_string( on_min, pgmStr, format, true );
-   pgmStr += "M ";
-   etl::to_string( on_sec, pgmStr, format, true );
-   pgmStr += "s o ";
-   etl::to_string( off_min, pgmStr, format, true );
-   pgmStr += "M ";
-   etl::to_string( off_sec, pgmStr, format, true );
-   pgmStr += "s *";
+   Program pgm;
 
-   program_manager.write_pgm_at( 0, pgmStr.c_str() );
+   pgm.push_back( Command{ Command::close, to_ticks( on_min, on_sec ) } );
+   pgm.push_back( Command{ Command::open, to_ticks( off_min, off_sec ) } );
+   pgm.push_back( Command{ Command::loop } );
 
-   // Reload it
-   program_manager.load( 0 );
+   // Written in the background - so use the copy in RAM
+   program_manager.write_pgm_at( 0, pgm );
+   program_manager.load( pgm, false );
 }
 
 void UIModel::select_pgm()
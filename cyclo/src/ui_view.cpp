@@ -31,9 +31,6 @@ SOFTWARE.
 #include "asx.h"
 #include "resource.h"
 
-#include <etl/format_spec.h>
-#include <etl/to_string.h>
-
 #include <logger.h>
 
 namespace
@@ -49,14 +46,34 @@ UIView::UIView( UIModel &model ) : model{ model }
    gfx_mono_init();
 }
 
+void UIView::invalidate()
+{
+   prog.invalidate();
+   walkman.invalidate();
+   counter.invalidate();
+   contact.invalidate();
+   nonc.invalidate();
+}
+
+void UIView::flush()
+{
+   gfx_mono_flush();
+}
+
 void UIView::draw()
 {
-   // Clear the screen (init is faster than drawing a rectangle)
-   gfx_mono_init();
+   // Clear the screen
+   gfx_mono_clear();
+   invalidate();
 
    draw_box();
    draw_prog();
    draw_walkman();
+   compose();
+}
+
+void UIView::compose()
+{
    draw_counter();
    draw_contact();
    draw_nonc();
@@ -64,11 +81,17 @@ void UIView::draw()
 
 void UIView::draw_splash()
 {
+   invalidate();
    gfx_mono_put_bitmap( &logo_bm, 0, 0 );
 }
 
 void UIView::draw_prog( bool highlight )
 {
+   if ( not prog.update( ( uint8_t( model.get_pgm() ) << 1 ) | highlight ) )
+   {
+      return;
+   }
+
    // Clear to overwrite
    gfx_mono_draw_filled_rect( 14, 3, 24, 10, GFX_PIXEL_CLR );
 
@@ -95,12 +118,13 @@ void UIView::draw_prog( bool highlight )
       }
       else
       {
-         etl::string<2>   pgmStr{ "P" };
-         etl::format_spec format;
+         uint8_t digits = model.get_pgm() < 10 ? 1 : 2;
 
-         format.width( 1 ).decimal();
-         etl::to_string( model.get_pgm() % 10, pgmStr, format, true );
-         gfx_mono_draw_string( pgmStr.c_str(), 20, 4, &sysfont );
+         // Keep centered in the box
+         gfx_coord_t x = digits == 1 ? 20 : 17;
+
+         gfx_mono_draw_char( 'P', x, 4, &sysfont );
+         gfx_mono_draw_digits( model.get_pgm(), digits, x + sysfont.width, 4, &sysfont );
       }
 
       if ( highlight )
@@ -112,6 +136,11 @@ void UIView::draw_prog( bool highlight )
 
 void UIView::draw_contact()
 {
+   if ( not contact.update( model.contact_is_open() ) )
+   {
+      return;
+   }
+
    if ( model.contact_is_open() )
    {
       gfx_mono_put_bitmap( &switch_opened_bm, 11, 48 );
@@ -124,38 +153,50 @@ void UIView::draw_contact()
 
 void UIView::draw_nonc()
 {
+   if ( not nonc.update( model.contact_is_no() ) )
+   {
+      return;
+   }
+
    gfx_mono_draw_string( model.contact_is_no() ? "NO" : "NC", 35, 52, &sysfont );
 }
 
 void UIView::draw_counter()
 {
-   int32_t          counter = model.get_counter();
-   etl::string<5>   cntStr{ "-----" };
-   etl::format_spec format;
-
-   format.width( 5 ).fill( '0' ).decimal();
+   int32_t     counter = model.get_counter();
+   gfx_coord_t x       = 15;
 
-   if ( counter >= 0 )
+   // Only negative values show as dashes
+   if ( not this->counter.update( counter < 0 ? -1 : counter ) )
    {
-      if ( counter < 100000 )
-      {
-         etl::to_string( counter, cntStr, format );
-      }
-      else
-      {
-         // Display the number with a + for large cycles
-         cntStr == "+";
-         etl::to_string( counter % 100000, cntStr, format, true );
-      }
+      return;
    }
 
-   gfx_mono_draw_string( cntStr.c_str(), 15, 36, &sysfont );
+   if ( counter < 0 )
+   {
+      gfx_mono_draw_string( "-----", x, 36, &sysfont );
+   }
+   else if ( counter < 100000 )
+   {
+      gfx_mono_draw_digits( counter, 5, x, 36, &sysfont );
+   }
+   else
+   {
+      // Display the lower digits with a + for large cycles
+      gfx_mono_draw_char( '+', x, 36, &sysfont );
+      gfx_mono_draw_digits( counter, 4, x + sysfont.width, 36, &sysfont );
+   }
 }
 
 void UIView::draw_walkman( uint8_t select )
 {
    uint8_t x = 13;
 
+   if ( not walkman.update( ( model.get_state() << 2 ) | select ) )
+   {
+      return;
+   }
+
    // Need to erase the right hand icon
    auto erase_adjacent = [] { gfx_mono_draw_filled_rect( 29, 17, 13, 13, GFX_PIXEL_CLR ); };
 
@@ -229,7 +270,8 @@ void UIView::erase_cursor( uint8_t pos )
 void UIView::draw_program_setup_dialog()
 {
    // Clear the screen
-   gfx_mono_init();
+   gfx_mono_clear();
+   invalidate();
 
    // Draw the time for close
    gfx_mono_draw_string( "T:", 4, 4, &sysfont );
@@ -274,8 +316,6 @@ void UIView::manual_program_draw_digit( show_digit_t show, uint8_t row, uint8_t
    uint8_t                  y              = 20 + 32 * row;
    static constexpr uint8_t MINUTES_COLUMN = 0;
    static constexpr uint8_t ON_ROW         = 0;
-   etl::string<2>           digits;
-   etl::format_spec         format;
 
    // Clear the area
    if ( show == back_to_normal )
@@ -294,8 +334,7 @@ void UIView::manual_program_draw_digit( show_digit_t show, uint8_t row, uint8_t
       show ? "<<" : "" );
 
 
-   format.width( 2 ).fill( '0' );
-   gfx_mono_draw_string( etl::to_string( value, digits, format ).c_str(), x, y, &sysfont );
+   gfx_mono_draw_digits( value, 2, x, y, &sysfont );
 
    // Inverse the digits
    if ( show == first_highlight )
@@ -312,5 +351,6 @@ void UIView::manual_program_draw_digit( show_digit_t show, uint8_t row, uint8_t
 
 void UIView::draw_usb()
 {
+   invalidate();
    gfx_mono_put_bitmap( &usb_symbol_bm, 0, 0 );
 }
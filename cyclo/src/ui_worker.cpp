@@ -31,21 +31,27 @@ SOFTWARE.
 #include <logger.h>
 
 
-using namespace rtos::tick;
-
 namespace
 {
    const char *const DOM = "ui_worker";
+
+   ///< Time between 2 frames in ms
+   constexpr uint32_t frame_period = 1000 / cyclo::ui_frame_rate;
+
+   ///< Time the splash screen is shown in ms
+   constexpr uint32_t splash_time = 1500;
 }
 
 UIWorker::UIWorker( ProgramManager &program_manager )
-   : splash_timer{ [] { fx::publish( msg::EndOfSplash{} ); } }
-   , model{ program_manager }
+   : model{ program_manager }
    , view{ model }
    , controller{ model, view }
    , program_manager{ program_manager }
 {
    LOG_HEADER( DOM );
+
+   // Show the splash
+   view.flush();
 }
 
 // @return true if the controller is in USB state
@@ -74,6 +80,17 @@ bool UIWorker::can_update()
    return not ( is_in_splash or is_in_program_setup );
 }
 
+// Have the changes to the model drawn with the next frame
+// The first change starts the frame timer, so the screen is only redrawn once per period
+//  however fast the changes come, and not at all when nothing changes
+void UIWorker::request_frame()
+{
+   if ( not next_frame.is_pending() )
+   {
+      next_frame = fx::publish_after( msg::RenderFrame{}, frame_period );
+   }
+}
+
 // --------------------------------------------------------------
 // Message handlers
 // --------------------------------------------------------------
@@ -82,7 +99,7 @@ void UIWorker::on_receive( const fx::DispatcherStarted &msg )
    LOG_HEADER( DOM );
    LOG_TRACE( DOM, "DispatcherStarted" );
 
-   splash_timer.start( 1.5_s );
+   fx::publish_after( msg::EndOfSplash{}, splash_time );
 }
 
 void UIWorker::on_receive( const msg::EndOfSplash &msg )
@@ -93,23 +110,17 @@ void UIWorker::on_receive( const msg::EndOfSplash &msg )
    // Feed into the SM
    process_event( controller, splash_timeout{} );
 
-   // Is there an auto_start program?
+   // Is there an auto_start program? It was started at boot - only show it
    if ( program_manager.starts_automatically() )
    {
-      // Parse it
-      program_manager.load( program_manager.get_autostart_index() );
-
-      // Start!
-      fx::publish( msg::StartProgram{ true } );
-
-      // Set the running state
       model.set_pgm( program_manager.get_autostart_index() );
-      model.set_state( UIModel::program_state_t::running );
    }
    else if ( program_manager.get_lastused_index() >= 0 )
    {
       model.set_pgm( program_manager.get_lastused_index() );
    }
+
+   view.flush();
 }
 
 void UIWorker::on_receive( const msg::Keypad &msg )
@@ -124,6 +135,8 @@ void UIWorker::on_receive( const msg::Keypad &msg )
    case KEY_SELECT: process_event( controller, push{} ); break;
    default: assert( 0 );
    }
+
+   view.flush();
 }
 
 void UIWorker::on_receive( const msg::NoNcUpdate &msg )
@@ -131,10 +144,7 @@ void UIWorker::on_receive( const msg::NoNcUpdate &msg )
    LOG_HEADER( DOM );
    LOG_TRACE( DOM, "NoNcUpdate" );
 
-   if ( can_update() )
-   {
-      view.draw_nonc();
-   }
+   request_frame();
 }
 
 void UIWorker::on_receive( const msg::CounterUpdate & )
@@ -145,10 +155,7 @@ void UIWorker::on_receive( const msg::CounterUpdate & )
    // Force the state to running
    model.set_state( UIModel::program_state_t::running );
 
-   if ( can_update() )
-   {
-      view.draw_counter();
-   }
+   request_frame();
 }
 
 void UIWorker::on_receive( const msg::ContactUpdate & )
@@ -156,10 +163,7 @@ void UIWorker::on_receive( const msg::ContactUpdate & )
    LOG_HEADER( DOM );
    LOG_TRACE( DOM, "ContactUpdate" );
 
-   if ( can_update() )
-   {
-      view.draw_contact();
-   }
+   request_frame();
 }
 
 void UIWorker::on_receive( const msg::USBConnected & )
@@ -176,6 +180,8 @@ void UIWorker::on_receive( const msg::USBConnected & )
    }
 
    process_event( controller, usb_on{} );
+
+   view.flush();
 }
 
 void UIWorker::on_receive( const msg::USBDisconnected & )
@@ -185,6 +191,8 @@ void UIWorker::on_receive( const msg::USBDisconnected & )
 
    model.set_state( UIModel::program_state_t::stopped );
    process_event( controller, usb_off{} );
+
+   view.flush();
 }
 
 void UIWorker::on_receive( const msg::ProgramIsStopped & )
@@ -194,4 +202,48 @@ void UIWorker::on_receive( const msg::ProgramIsStopped & )
 
    model.set_state( UIModel::program_state_t::stopped );
    process_event( controller, pgm_stopped{} );
+
+   view.flush();
+}
+
+void UIWorker::on_receive( const msg::NvmWriteDone & )
+{
+   LOG_HEADER( DOM );
+   LOG_TRACE( DOM, "NvmWriteDone" );
+
+   using namespace sml;
+
+   // The programs may have been saved or erased by the console - so do not show a
+   //  slot which is gone. The manual program always exists
+   if ( model.get_pgm() > 0 and not program_manager.get_map()[ model.get_pgm() ] )
+   {
+      model.set_pgm( 0 );
+
+      // The frames only compose the counter and the contact, so draw the program here.
+      // Keep it highlighted while it is being selected
+      if ( can_update() )
+      {
+         view.draw_prog(
+            controller.is<decltype( state<program_selection> )>( "program_selected"_s ) );
+      }
+
+      // Have it sent to the screen
+      request_frame();
+   }
+}
+
+void UIWorker::on_receive( const msg::RenderFrame & )
+{
+   LOG_HEADER( DOM );
+   LOG_TRACE( DOM, "RenderFrame" );
+
+   // Delivered - the slot may be reused
+   next_frame = fx::TimerHandle{};
+
+   if ( can_update() )
+   {
+      view.compose();
+   }
+
+   view.flush();
 }
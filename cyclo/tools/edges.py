@@ -0,0 +1,114 @@
+#!/usr/bin/env python3
+"""
+Decode the binary edge log sent by the 'edges' console command.
+
+The dump is read either from a capture file, or straight from the cyclo
+ serial port (requires pyserial), in which case the command is sent first.
+Anything preceding the 'CYED' magic (such as the echo of the command) is skipped.
+"""
+import struct
+import sys
+
+MAGIC = b"CYED"
+VERSION = 2
+HEADER = struct.Struct("<4sBBBBHII")
+RECORD = struct.Struct("<IBB")
+NO_STEP = 0xff
+
+EDGES = {
+   0x00: "relay open",
+   0x01: "relay close",
+   0x80: "sense NC",
+   0x81: "sense NO",
+}
+
+
+class DecodeException(Exception):
+   pass
+
+
+def read_from_port(port, timeout):
+   import serial
+
+   with serial.Serial(port, timeout=timeout) as s:
+      s.reset_input_buffer()
+      s.write(b"edges\r")
+
+      # The header gives the size of the rest
+      data = s.read_until(MAGIC)
+
+      if not data.endswith(MAGIC):
+         raise DecodeException("No reply from the device")
+
+      data = MAGIC + s.read(HEADER.size - len(MAGIC))
+      count, record_size = data[6], data[5]
+      data += s.read(count * record_size)
+
+      return data
+
+
+def decode(data):
+   start = data.find(MAGIC)
+
+   if start < 0:
+      raise DecodeException("No edge log found")
+
+   data = data[start:]
+
+   if len(data) < HEADER.size:
+      raise DecodeException("Truncated header")
+
+   _, version, record_size, count, _, total, now, first = HEADER.unpack_from(data)
+
+   if version != VERSION or record_size != RECORD.size:
+      raise DecodeException(f"Unsupported version {version} (record size {record_size})")
+
+   if len(data) < HEADER.size + count * record_size:
+      raise DecodeException("Truncated records")
+
+   records = [
+      RECORD.unpack_from(data, HEADER.size + i * record_size) for i in range(count)]
+
+   return total, now, first, records
+
+
+def show(total, now, first, records):
+   lost = (total - len(records)) & 0xffff
+   print(f"# {len(records)} edges, {total} recorded, {lost} overwritten")
+
+   if total:
+      print(f"# First edge {first / 1e6:.6f}s after boot")
+
+   prev = None
+
+   for timestamp, flags, step in records:
+      # Timestamps wrap every 2^32 us, the age is relative to the dump
+      age = ((now - timestamp) & 0xffffffff) / 1e6
+      delta = "" if prev is None else f"{((timestamp - prev) & 0xffffffff) / 1e6:+14.6f}s"
+      what = EDGES.get(flags, f"0x{flags:02x}")
+      where = "" if step == NO_STEP else f"step {step}"
+      print(f"{-age:14.6f}s {delta:15} {what:12} {where}")
+      prev = timestamp
+
+
+if __name__ == "__main__":
+   import argparse
+
+   parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+   group = parser.add_mutually_exclusive_group(required=True)
+   group.add_argument('-p', dest='port', help='Serial port of the device')
+   group.add_argument('-f', dest='file', help='Raw capture of the dump')
+   parser.add_argument('-t', dest='timeout', type=float, default=2.0, help='Read timeout in seconds')
+   args = parser.parse_args()
+
+   try:
+      if args.port:
+         data = read_from_port(args.port, args.timeout)
+      else:
+         with open(args.file, "rb") as f:
+            data = f.read()
+
+      show(*decode(data))
+   except DecodeException as e:
+      print(f"Error: {e}", file=sys.stderr)
+      sys.exit(1)
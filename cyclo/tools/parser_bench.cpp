@@ -0,0 +1,106 @@
+///\file
+
+/******************************************************************************
+The MIT License(MIT)
+https://github.com/adarwoo/cyclo
+
+Copyright(c) 2021 Guillaume ARRECKX - software@arreckx.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+******************************************************************************/
+
+/*
+ * Host benchmark of the program parser
+ * Times the parsing of a set of typical lines by the current parser, and by the
+ *  frozen copy of the etl::tokenizer based one (parser_legacy.cpp), in the same
+ *  run. Prints the average time per line of each.
+ * The logger is compiled out, as in the release firmware.
+ *
+ * Build and run from the cyclo directory:
+ *  g++ -O2 -std=c++17 -D_POSIX -DFORCE_NODEBUG -DGFX_MONO_UG_2832HSWEG04=1 -Isrc -Isrc/include -Isrc/config \
+ *    -Isrc/logger/include -Isrc/simulation/include -Isrc/ASF/common/services/gfx_mono \
+ *    tools/parser_bench.cpp tools/parser_legacy.cpp src/parser.cpp src/program.cpp \
+ *    -o /tmp/parser_bench && /tmp/parser_bench
+ */
+#include "parser.hpp"
+#include "parser_legacy.hpp"
+
+#include <chrono>
+#include <cstdio>
+
+namespace
+{
+   ///< Typical console input - programs first, then commands and errors
+   const char *const lines[] = {
+      "o 1 500m c 1H 30M",
+      "close 250m open 10 c o *",
+      "c 1M 0s o 0M 5s *",
+      "o 10 c 20 o 30 c 40 o 50 c 60 o 70 c 80 *",
+      "open 1H close 1H open 1H close 1H",
+      "12",
+      "run 3",
+      "save 14",
+      "auto off",
+      "list",
+      "o 1x",
+      "close 5 frobnicate",
+   };
+
+   constexpr unsigned ROUNDS = 200000;
+
+   constexpr unsigned COUNT = ROUNDS * ( sizeof( lines ) / sizeof( lines[ 0 ] ) );
+
+   ///< @return The average time to parse a line, in ns
+   template<typename P>
+   double time_parser()
+   {
+      using clock = std::chrono::steady_clock;
+
+      Program          program;
+      etl::string<60>  error;
+      P                parser( program, error );
+      volatile uint8_t sink = 0;
+
+      auto start = clock::now();
+
+      for ( unsigned i = 0; i < ROUNDS; ++i )
+      {
+         for ( auto line : lines )
+         {
+            sink = sink + static_cast<uint8_t>( parser.parse( line ) );
+         }
+      }
+
+      return std::chrono::duration<double, std::nano>( clock::now() - start ).count() / COUNT;
+   }
+}  // namespace
+
+int main()
+{
+   // Interleaved, so both see the same machine load
+   double legacy = time_parser<LegacyParser>();
+   double parser = time_parser<Parser>();
+
+   legacy = ( legacy + time_parser<LegacyParser>() ) / 2;
+   parser = ( parser + time_parser<Parser>() ) / 2;
+
+   printf( "%u lines parsed by each\n", COUNT );
+   printf( "  tokenizer (legacy) : %6.1f ns per line\n", legacy );
+   printf( "  single pass lexer  : %6.1f ns per line\n", parser );
+
+   return 0;
+}
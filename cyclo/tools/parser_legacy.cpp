@@ -0,0 +1,408 @@
+/******************************************************************************
+The MIT License(MIT)
+https://github.com/adarwoo/cyclo
+
+Copyright(c) 2021 Guillaume ARRECKX - software@arreckx.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+******************************************************************************/
+/*
+ * Frozen copy of the parser before the single pass lexer (see parser_legacy.hpp)
+ */
+#include "parser_legacy.hpp"
+
+#include "program.hpp"
+
+#include <etl/algorithm.h>
+#include <etl/basic_string.h>
+#include <etl/string.h>
+#include <etl/string_view.h>
+#include <etl/to_string.h>
+#include <etl/tokenizer.h>
+#include <etl/vector.h>
+
+#include <cctype>
+
+#include <logger.h>
+
+// Construct a parser
+LegacyParser::LegacyParser( Program &program, etl::istring &error )
+   : live_{ program }, err_( error ), buffer_{ nullptr }, distance{0}, program_number{-1}
+{}
+
+/**
+ * Check if the token is a delay.
+ * An error can be triggered
+ *
+ * @return 0 if not, otherwise the correct delay in ms
+ */
+bool LegacyParser::get_delay( uint32_t &value, const etl::string_view token )
+{
+   using Item  = etl::pair<const char *, uint32_t>;
+   bool retval = false;
+
+   // Units conversion table
+   static constexpr Item unit_lut[] = {
+      { "H", 60ul * 60ul * 1000ul },
+      { "M", 60ul * 1000ul },
+      { "s", 1000 },
+      { "m", 1 },
+      { "", 1000 } };
+
+   // Check if the first char is a digit before perusing
+   if ( ::isdigit( token.front() ) )
+   {
+      // Convert
+      auto unit_start = token.begin();
+      auto number     = strtoul( unit_start, const_cast<char **>( &unit_start ), 10 );
+      auto unit       = etl::string_view( unit_start, token.end() );
+
+      // Is it a program number rather?
+      if ( number < cyclo::max_programs and unit.size() == 0 )
+      {
+         program_number = number;
+      }
+
+      auto foundit =
+         etl::find_if( etl::begin( unit_lut ), etl::end( unit_lut ), [ unit ]( const Item &i ) {
+            return unit == i.first;
+         } );
+
+      if ( foundit != etl::end( unit_lut ) )
+      {
+         value  = number * foundit->second;
+         retval = true;
+      }
+      else
+      {
+         err_ = "Invalid unit: '";
+         err_.append( unit.data(), unit.size() );
+         err_ += "\'";
+         error( unit_start );
+      }
+   }
+
+   return retval;
+}
+
+/**
+ * @param token String containing the value to convert
+ * @return true on success. If false, err_ contains the error descruption
+ */
+bool LegacyParser::parse_program_number( const etl::string_view token )
+{
+   auto retval = false;
+
+   // Mark as none
+   program_number = -1;
+
+   // Must be 1 or 2 digits, within the number of programs
+   uint8_t number = 0;
+
+   for ( auto c : token )
+   {
+      if ( not ::isdigit( c ) or token.size() > 2 )
+      {
+         error( token );
+         return false;
+      }
+
+      number = number * 10 + c - '0';
+   }
+
+   if ( number < cyclo::max_programs )
+   {
+      program_number = number;
+      retval         = true;
+   }
+   else
+   {
+      error( token );
+   }
+
+   return retval;
+}
+
+/**
+ * @param c Command to insert into the program
+ * @param token Actual command element
+ */
+void LegacyParser::safe_insert( Command::command_t c, etl::string_view token )
+{
+   if ( not live_.empty() and live_.back().command == Command::loop )
+   {
+      err_.assign( "No commands allowed past *" );
+      error( token );
+   }
+   else if ( live_.empty() and c == Command::loop )
+   {
+      err_.assign( "Loop not allowed as first action" );
+      error( token );
+   }
+   else
+   {
+      bool room = true;
+
+      if ( c != Command::delay )
+      {
+         // Force a 1 second delay unless given
+         if ( not live_.empty() and live_.back().ticks == 0 )
+         {
+            LOG_DEBUG( "parser", "Adding 1s delay" );
+            room = live_.add_delay( Command::to_ticks( 1000 ) );
+         }
+      }
+
+      LOG_DEBUG( "parser", "Adding item: '%c'", c );
+
+      // Insert a new command
+      if ( not ( room and live_.push_back( Command( c ) ) ) )
+      {
+         err_.assign( "Too many items" );
+         error( token );
+      }
+   }
+}
+
+/**
+ * @param buffer The buffer to parse
+ * @return A parsing can return an program, a interactive command, nothing
+ *          or an error. The calling entity should switch case the result
+ *          to process the result.
+ *         If the result is error, the supplied error string will contain
+ *          the error text description, along with the method get_error_position
+ *          which can point to the actual location of the error in the supplied string.
+ *         If the result is a command, and the command requires a program number,
+ *          the accessor get_program_number will provide the value.
+ *         An empty (or space only) string returns 'nothing'.
+ *         Finally, a return value 'program' indicate the program is available from
+ *          the supplied program object.
+ */
+LegacyParser::Result LegacyParser::parse( const etl::string_view &buffer )
+{
+   enum : uint8_t { more, no_more, program, program_not_0, program_or_off } expects = more;
+
+
+   auto retval = Result::program; // Default is to expect a program
+
+   // Reset all to allow multiple calls
+   buffer_     = buffer.begin();
+   live_.clear();
+   err_.clear();
+
+   // Invalidate the program number
+   program_number = 255;
+
+   LOG_INFO( "parser", "Parsing: %s", etl::string<60>( buffer ).c_str() );
+
+   for ( auto token : etl::tokenizer( buffer, etl::char_separator( " ," ) ) )
+   {
+      // Lambdas to scope things a bit
+      auto is_command = [ token ]( etl::string_view command ) {
+         return command.starts_with( token );
+      };
+
+      // Check extra args
+      if ( expects == no_more )
+      {
+         err_ = "Unexpected extra arg(s): '";
+         err_.append( token.data(), token.size() );
+         err_ += "\'";
+         error( token );
+      }
+
+      // Break on error
+      if ( not err_.empty() )
+      {
+         break;
+      }
+
+      uint32_t number;
+
+      if ( expects == program_or_off )
+      {
+         if ( (not parse_program_number(token)) and token != "off" )
+         {
+            err_ = "Expecting the program number [0 to ";
+            etl::to_string( cyclo::max_programs - 1, err_, true );
+            err_ += "] or 'off'";
+         }
+         else
+         {
+            expects = no_more;
+         }
+      }
+      else if ( expects == program or expects == program_not_0 )
+      {
+         if ( not parse_program_number(token) )
+         {
+            err_ = "Expecting a number ";
+
+            if ( expects == program )
+            {
+               err_ += '0';
+            }
+            else
+            {
+               err_ += '1';
+            }
+
+            err_ += " to ";
+            etl::to_string( cyclo::max_programs - 1, err_, true );
+         }
+         else
+         {
+            expects = no_more;
+         }
+      }
+      else if ( get_delay( number, token ) )
+      {
+         if ( not live_.empty() )
+         {
+            LOG_DEBUG( "parser", "Adding %dms delay", number );
+
+            if ( not live_.add_delay( Command::to_ticks( number ) ) )
+            {
+               err_.assign( "Too many items" );
+               error( token );
+            }
+         }
+         else
+         {
+            safe_insert( Command::delay, token );
+         }
+      }
+      else if ( err_.empty() )
+      {
+         if ( is_command( "open" ) )
+         {
+            safe_insert( Command::open, token );
+         }
+         else if ( is_command( "close" ) )
+         {
+            safe_insert( Command::close, token );
+         }
+         else if ( token == "*" )
+         {
+            // Loop - must be the last command
+            safe_insert( Command::loop, token );
+         }
+         else
+         {
+            if ( not live_.empty() )
+            {
+               err_ = "Unexpected: '";
+               err_.append( token.data(), token.size() );
+               err_ += "\'";
+               error( token );
+            }
+            else if ( is_command( "help" ) )
+            {
+               retval  = Result::help;
+               expects = no_more;
+            }
+            else if ( is_command( "list" ) )
+            {
+               retval  = Result::list;
+               expects = no_more;
+            }
+            else if ( is_command( "edges" ) )
+            {
+               retval  = Result::edges;
+               expects = no_more;
+            }
+            else if ( is_command( "verify" ) )
+            {
+               retval  = Result::verify;
+               expects = no_more;
+            }
+            else if ( is_command( "quit" ) )
+            {
+               retval  = Result::quit;
+               expects = no_more;
+            }
+            else if ( is_command( "auto" ) )
+            {
+               retval  = Result::autostart;
+               expects = program_or_off;
+            }
+            else if ( is_command( "save" ) )
+            {
+               retval  = Result::save;
+               expects = program_not_0;
+            }
+            else if ( is_command( "run" ) )
+            {
+               retval  = Result::run;
+               expects = program;
+            }
+            else if ( is_command( "delete" ) )
+            {
+               retval  = Result::del;
+               expects = program_not_0;
+            }
+            else
+            {
+               err_ = "Unexpected: '";
+               err_.append( token.data(), token.size() );
+               err_ += "\'";
+               error( token );
+            }
+         }
+      }
+   }
+
+   // Any errors? - Return an error
+   if ( not err_.empty() )
+   {
+      retval = Result::error;
+   }
+   else if ( retval == Result::program )
+   {
+      if ( live_.empty() )
+      {
+         retval = Result::nothing;
+      }
+      else
+      {
+         // If the command only has a delay - check if it is a program number
+         if ( live_.size() == 1 and live_.back().command == Command::delay )
+         {
+            // Check the number
+            if ( program_number == 255 )
+            {
+               err_ = "Bad program number or delay without command";
+               retval = Result::error;
+            }
+            else
+            {
+               // It is in fact a run command
+               retval = Result::run;
+            }
+         }
+      }
+   }
+   // Make sure all required args supplied
+   else if ( expects != no_more )
+   {
+      err_ = "Missing argument";
+      retval = Result::error;
+   }
+   // else a interactive command was entered
+
+   return retval;
+}
@@ -0,0 +1,137 @@
+///\file
+
+/******************************************************************************
+The MIT License(MIT)
+https://github.com/adarwoo/cyclo
+
+Copyright(c) 2021 Guillaume ARRECKX - software@arreckx.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+******************************************************************************/
+
+
+/*
+ * Host benchmark of the dispatch policies of the UI state machine
+ * Runs the UI controller built with each sml dispatch policy, and prints the number of events
+ *  processed per second. Two loads are timed: events which no state handles, which measure the
+ *  dispatch alone, and a navigation round trip between the program selection and the walkman,
+ *  which includes the actions and the drawing into the framebuffer.
+ * The display is stubbed out, so the simulation objects are linked without their X11 display.
+ *
+ * Build and run from the cyclo directory, once the simulation is built (make SIM=1):
+ *  g++ -O2 -std=c++17 -Wno-subobject-linkage -fno-exceptions -DBOARD=USER_BOARD -DGFX_MONO_UG_2832HSWEG04=1 \
+ *    -D_POSIX -DFORCE_NODEBUG -Isrc -Isrc/include -Isrc/config -Isrc/FreeRTOS/Source/include \
+ *    -Isrc/logger/include -Isrc/boost -Isrc/fx/include -Isrc/rtos++/include \
+ *    -Isrc/FreeRTOS/Source/portable/ThirdParty/GCC/Posix -Isrc/FreeRTOS/Source/portable/ThirdParty/GCC/Posix/utils \
+ *    -Isrc/simulation/include -Isrc/ASF/common/services/gfx_mono tools/sml_bench.cpp \
+ *    $(find sim_release -name '*.o' ! -name main.o ! -name ssd1306.o) -pthread -lrt -lX11 -o /tmp/sml_bench \
+ *    && /tmp/sml_bench
+ *
+ * The flash used by each policy on the target is reported by tools/sml_size.sh
+ */
+#include "ui_controller.hpp"
+#include "program_manager.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <unistd.h>
+
+extern "C"
+{
+   // No display
+   void ssd1306_init( void ) {}
+   void ssd1306_set_display_start_line_address( uint8_t ) {}
+   void ssd1306_set_page_address( uint8_t ) {}
+   void ssd1306_set_column_address( uint8_t ) {}
+   void ssd1306_write_data( uint8_t ) {}
+   void ssd1306_write_data_buffer( const uint8_t *, uint8_t ) {}
+   uint8_t ssd1306_read_data() { return 0; }
+   void ssd1306_queue_data( uint8_t, uint8_t, const uint8_t *, uint8_t ) {}
+   void ssd1306_send_queued( void ) {}
+
+   void nvm_init();
+}
+
+namespace
+{
+   constexpr unsigned ROUNDS = 200000;
+
+   using clock = std::chrono::steady_clock;
+
+   ///< @return The number of events per second
+   template<class TFunction>
+   double time( unsigned events, TFunction &&f )
+   {
+      auto start = clock::now();
+
+      f();
+
+      return events / std::chrono::duration<double>( clock::now() - start ).count();
+   }
+
+   template<class TPolicy>
+   void bench( const char *name, UIModel &model, UIView &view )
+   {
+      sml::sm<sm_cyclo, sml::dispatch<TPolicy>> controller{ model, view };
+
+      // Leave the splash for the program selection of the manual mode
+      process_event( controller, splash_timeout{} );
+
+      auto unhandled = time( ROUNDS * 3, [&] {
+         for ( unsigned i = 0; i < ROUNDS; ++i )
+         {
+            process_event( controller, usb_off{} );
+            process_event( controller, pgm_stopped{} );
+            process_event( controller, splash_timeout{} );
+         }
+      } );
+
+      // Down into the walkman, then up again into the program selection
+      auto navigation = time( ROUNDS * 2, [&] {
+         for ( unsigned i = 0; i < ROUNDS; ++i )
+         {
+            process_event( controller, down{} );
+            process_event( controller, up{} );
+         }
+      } );
+
+      printf(
+         "%-12s %8.2f M unhandled events/s %8.2f M navigation events/s\n", name, unhandled / 1e6,
+         navigation / 1e6 );
+   }
+}  // namespace
+
+int main()
+{
+   setvbuf( stdout, nullptr, _IONBF, 0 );
+
+   nvm_init();
+
+   ProgramManager pgm_manager;
+   UIModel        model{ pgm_manager };
+   UIView         view{ model };
+
+   using namespace sml::back::policies;
+
+   bench<jump_table>( "jump_table", model, view );
+   bench<branch_stm>( "branch_stm", model, view );
+   bench<switch_stm>( "switch_stm", model, view );
+   bench<fold_expr>( "fold_expr", model, view );
+
+   // The simulation does not shut down cleanly
+   _exit( 0 );
+}
@@ -0,0 +1,28 @@
+#!/usr/bin/env bash
+#
+# Report the flash and RAM used on the target by each dispatch policy of the UI state machine.
+# Rebuilds the firmware once per policy, so the AVR toolchain must be in the path.
+# Run from the cyclo directory. The firmware is left built with the default policy.
+#
+set -e
+
+POLICIES="jump_table branch_stm switch_stm fold_expr"
+BUILD_DIR=avr_release
+
+printf "%-12s %10s %10s %10s %10s\n" policy ui_text ui_data flash ram
+
+for policy in $POLICIES ""; do
+   # The policy is not tracked by the dependencies, so drop every object that includes ui_controller.hpp
+   for dep in $(grep -rl --include='*.d' 'ui_controller\.hpp' $BUILD_DIR 2>/dev/null); do
+      rm -f ${dep%.d}.o
+   done
+
+   make -s UI_SM_DISPATCH=$policy > /dev/null
+
+   [ -n "$policy" ] || break
+
+   read ui_text ui_data ui_bss <<< $(avr-size $BUILD_DIR/src/ui_worker.o | awk 'NR==2 {print $1, $2, $3}')
+   read text data bss <<< $(avr-size $BUILD_DIR/cyclo.elf | awk 'NR==2 {print $1, $2, $3}')
+
+   printf "%-12s %10d %10d %10d %10d\n" $policy $ui_text $ui_data $((text + data)) $((data + bss))
+done